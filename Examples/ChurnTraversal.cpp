@@ -0,0 +1,104 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "PerformanceTest.h"
+#include "GrowingMemoryPool.h"
+#include <vector>
+#include <random>
+#include <algorithm>
+
+const unsigned numberOfNodes = 2 * 1024 * 1024;
+const unsigned numberOfTraversals = 8;
+const unsigned growByNumberOfElements = 64 * 1024;
+
+struct Node
+{
+    Node *next;
+    unsigned value;
+    unsigned padding[5];
+};
+
+typedef GrowingMemoryPool<Node> NodePool;
+
+// Releases all nodes in random order, as after long churn
+static void churn(NodePool &pool)
+{
+    std::vector<Node *> nodes(numberOfNodes);
+    for(unsigned index = 0; index < numberOfNodes; index++)
+        nodes[index] = pool.allocateBlock();
+
+    std::shuffle(nodes.begin(), nodes.end(), std::minstd_rand(2016));
+    for(unsigned index = 0; index < numberOfNodes; index++)
+        pool.releaseBlock(nodes[index]);
+}
+
+// Builds a list of nodes allocated one after another and traverses it
+static void buildAndTraverse(NodePool &pool)
+{
+    Node *head = NULL;
+    for(unsigned index = 0; index < numberOfNodes; index++) {
+        Node *node = pool.allocateBlock();
+        node->next = head;
+        node->value = index;
+        head = node;
+    }
+
+    volatile unsigned sum = 0;
+    for(unsigned traversal = 0; traversal < numberOfTraversals; traversal++)
+        for(Node *node = head; node; node = node->next)
+            sum += node->value;
+}
+
+PERFORMANCE_TEST(ChurnTraversal, UnsortedFreeList)
+{
+    NodePool pool(growByNumberOfElements);
+
+    churn(pool);
+    buildAndTraverse(pool);
+}
+
+PERFORMANCE_TEST(ChurnTraversal, SortedFreeList)
+{
+    NodePool pool(growByNumberOfElements);
+
+    churn(pool);
+    pool.sortFreeList();
+    buildAndTraverse(pool);
+}
+
+PERFORMANCE_TEST(ChurnTraversal, SortThreshold)
+{
+    NodePool pool(growByNumberOfElements);
+    pool.setSortThreshold(numberOfNodes / 4);
+
+    churn(pool);
+    buildAndTraverse(pool);
+}
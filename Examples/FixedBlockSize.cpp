@@ -0,0 +1,78 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "PerformanceTest.h"
+#include "FixedMemoryPool.h"
+#include <vector>
+
+const unsigned numberOfBlocks = 1024;
+const unsigned numberOfRounds = 64 * 1024;
+
+struct Block
+{
+    unsigned value[6];
+};
+
+typedef FixedMemoryPool<sizeof(Block)> BlockPool;
+
+static std::vector<std::uint8_t> memoryRegion(BlockPool::getMemoryRegionSize(numberOfBlocks));
+static std::vector<void *> blocks(numberOfBlocks);
+
+// Read through volatile, so that the compiler cannot fold it into a constant
+static volatile std::size_t runtimeBlockSize = sizeof(Block);
+
+// Block size known only at run time
+PERFORMANCE_TEST(FixedBlockSize, RuntimeBlockSize)
+{
+    MemoryPool pool;
+
+    for(unsigned round = 0; round < numberOfRounds; round++) {
+        ::inlinedInitializeMemoryPool(&pool, memoryRegion.data(), numberOfBlocks, runtimeBlockSize);
+        for(unsigned index = 0; index < numberOfBlocks; index++)
+            blocks[index] = ::inlinedAllocateBlock(&pool);
+        for(unsigned index = 0; index < numberOfBlocks; index++)
+            ::inlinedReleaseBlock(&pool, blocks[index]);
+    }
+}
+
+// Block size folded into the code as a constant
+PERFORMANCE_TEST(FixedBlockSize, CompileTimeBlockSize)
+{
+    BlockPool pool;
+
+    for(unsigned round = 0; round < numberOfRounds; round++) {
+        pool.initialize(memoryRegion.data(), numberOfBlocks);
+        for(unsigned index = 0; index < numberOfBlocks; index++)
+            blocks[index] = pool.allocateBlock();
+        for(unsigned index = 0; index < numberOfBlocks; index++)
+            pool.releaseBlock(blocks[index]);
+    }
+}
@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 
 #include "PerformanceTest.h"
 #include "MemoryPoolAllocator.h"
+#include "MemoryResource.h"
 #include <list>
 
 const unsigned numberOfIterations = 16 * 1024 * 1024;
@@ -40,6 +41,7 @@ typedef int DataType;
 typedef MemoryPoolAllocator<DataType> Allocator;
 typedef std::list<DataType> DefaultList;
 typedef std::list<DataType, Allocator> MemoryPoolList;
+typedef std::pmr::list<DataType> MemoryResourceList;
 
 PERFORMANCE_TEST(List, DefaultAllocator)
 {
@@ -57,3 +59,21 @@ PERFORMANCE_TEST(List, MemoryPoolAllocator)
     for(unsigned iteration = 0; iteration < numberOfIterations; iteration++)
         testList.push_back(iteration);
 }
+
+PERFORMANCE_TEST(List, UnsynchronizedPoolResource)
+{
+    std::pmr::unsynchronized_pool_resource memoryResource;
+    MemoryResourceList testList(&memoryResource);
+
+    for(unsigned iteration = 0; iteration < numberOfIterations; iteration++)
+        testList.push_back(iteration);
+}
+
+PERFORMANCE_TEST(List, PooledMemoryResource)
+{
+    UnsynchronizedPooledMemoryResource memoryResource(growByNumberOfElements);
+    MemoryResourceList testList(&memoryResource);
+
+    for(unsigned iteration = 0; iteration < numberOfIterations; iteration++)
+        testList.push_back(iteration);
+}
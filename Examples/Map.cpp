@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 
 #include "PerformanceTest.h"
 #include "MemoryPoolAllocator.h"
+#include "MemoryResource.h"
 #include <map>
 
 const unsigned numberOfIterations = 2 * 1024 * 1024;
@@ -42,6 +43,7 @@ typedef std::pair<const KeyType, DataType> Pair;
 typedef MemoryPoolAllocator<Pair> Allocator;
 typedef std::map<KeyType, DataType> DefaultMap;
 typedef std::map<KeyType, DataType, std::less<DataType>, Allocator> MemoryPoolMap;
+typedef std::pmr::map<KeyType, DataType> MemoryResourceMap;
 
 PERFORMANCE_TEST(Map, DefaultAllocator)
 {
@@ -59,3 +61,21 @@ PERFORMANCE_TEST(Map, MemoryPoolAllocator)
     for(unsigned iteration = 0; iteration < numberOfIterations; iteration++)
         testMap.insert(Pair(iteration, iteration));
 }
+
+PERFORMANCE_TEST(Map, UnsynchronizedPoolResource)
+{
+    std::pmr::unsynchronized_pool_resource memoryResource;
+    MemoryResourceMap testMap(&memoryResource);
+
+    for(unsigned iteration = 0; iteration < numberOfIterations; iteration++)
+        testMap.insert(Pair(iteration, iteration));
+}
+
+PERFORMANCE_TEST(Map, PooledMemoryResource)
+{
+    UnsynchronizedPooledMemoryResource memoryResource(growByNumberOfElements);
+    MemoryResourceMap testMap(&memoryResource);
+
+    for(unsigned iteration = 0; iteration < numberOfIterations; iteration++)
+        testMap.insert(Pair(iteration, iteration));
+}
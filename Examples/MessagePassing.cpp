@@ -0,0 +1,154 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "PerformanceTest.h"
+#include "SharedMemoryPool.h"
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/wait.h>
+
+const unsigned numberOfMessages = 256 * 1024;
+const unsigned numberOfBlocks = 1024;
+const char *const sharedMemoryName = "/FixMemAllocMessagePassing";
+
+struct Message
+{
+    std::uint32_t sequenceNumber;
+    std::uint8_t payload[1020];
+};
+
+typedef SharedMemoryPool<Message> MessagePool;
+
+static void readAll(int fileDescriptor, void *buffer, std::size_t size)
+{
+    std::uint8_t *pointer = static_cast<std::uint8_t *>(buffer);
+    while(size) {
+        ssize_t result = ::read(fileDescriptor, pointer, size);
+        if(result <= 0)
+            std::abort();
+
+        pointer += result;
+        size -= result;
+    }
+}
+
+static void writeAll(int fileDescriptor, const void *buffer, std::size_t size)
+{
+    const std::uint8_t *pointer = static_cast<const std::uint8_t *>(buffer);
+    while(size) {
+        ssize_t result = ::write(fileDescriptor, pointer, size);
+        if(result <= 0)
+            std::abort();
+
+        pointer += result;
+        size -= result;
+    }
+}
+
+// Runs producer in child process, which sends messages to the parent
+template <class Producer, class Consumer>
+static void passMessages(Producer producer, Consumer consumer)
+{
+    int pipeDescriptors[2];
+    if(::pipe(pipeDescriptors) != 0)
+        std::abort();
+
+    pid_t child = ::fork();
+    if(!child) {
+        ::close(pipeDescriptors[0]);
+        producer(pipeDescriptors[1]);
+        ::_exit(0);
+    }
+
+    ::close(pipeDescriptors[1]);
+    consumer(pipeDescriptors[0]);
+    ::close(pipeDescriptors[0]);
+    ::waitpid(child, NULL, 0);
+}
+
+// Whole messages are copied through the pipe
+PERFORMANCE_TEST(MessagePassing, Pipe)
+{
+    passMessages([](int fileDescriptor) {
+        Message message;
+        for(unsigned index = 0; index < numberOfMessages; index++) {
+            message.sequenceNumber = index;
+            message.payload[0] = static_cast<std::uint8_t>(index);
+            writeAll(fileDescriptor, &message, sizeof(message));
+        }
+    }, [](int fileDescriptor) {
+        Message message;
+        for(unsigned index = 0; index < numberOfMessages; index++) {
+            readAll(fileDescriptor, &message, sizeof(message));
+            if(message.sequenceNumber != index)
+                std::abort();
+        }
+    });
+}
+
+// Only indices of messages in shared memory are sent through the pipe
+PERFORMANCE_TEST(MessagePassing, SharedMemoryPool)
+{
+    MessagePool::remove(sharedMemoryName);
+    MessagePool pool(sharedMemoryName, numberOfBlocks);
+
+    passMessages([](int fileDescriptor) {
+        MessagePool pool(sharedMemoryName, numberOfBlocks);
+
+        for(unsigned index = 0; index < numberOfMessages; index++) {
+            Message *message;
+            while(!(message = pool.allocateBlock()))
+                std::this_thread::yield();
+
+            message->sequenceNumber = index;
+            message->payload[0] = static_cast<std::uint8_t>(index);
+
+            std::uint32_t messageIndex = pool.getIndex(message);
+            writeAll(fileDescriptor, &messageIndex, sizeof(messageIndex));
+        }
+    }, [&pool](int fileDescriptor) {
+        for(unsigned index = 0; index < numberOfMessages; index++) {
+            std::uint32_t messageIndex;
+            readAll(fileDescriptor, &messageIndex, sizeof(messageIndex));
+
+            Message *message = pool.getBlock(messageIndex);
+            if(message->sequenceNumber != index)
+                std::abort();
+            pool.releaseBlock(message);
+        }
+    });
+
+    MessagePool::remove(sharedMemoryName);
+}
+
+#endif
@@ -31,7 +31,6 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 
 #include <iostream>
 #include "PerformanceTest.h"
-#include "PerformanceTimer.h"
 
 PerformanceTest &PerformanceTest::getSingleInstance()
 {
@@ -54,14 +53,29 @@ void PerformanceTest::runAllTests()
         performanceTest.runSingleTest(*i);
 }
 
+void PerformanceTest::restartTimer()
+{
+    getSingleInstance().performanceTimer.start();
+}
+
+void PerformanceTest::stopTimer()
+{
+    PerformanceTest &performanceTest = getSingleInstance();
+
+    performanceTest.performanceTimer.stop();
+    performanceTest.isTimerStopped = true;
+}
+
 void PerformanceTest::runSingleTest(const PerformanceTestFunction *testFunction)
 {
     std::cout << "Starting " << testFunction->getTestName() << " test..." << std::endl;
 
-    PerformanceTimer performanceTimer;
+    isTimerStopped = false;
     performanceTimer.start();
     testFunction->testFunction();
-    performanceTimer.stop();
+
+    if(!isTimerStopped)
+        performanceTimer.stop();
 
     std::cout << "  Completed in: " << performanceTimer.getTime() << " sec." << std::endl;
     std::cout << std::endl;
@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #define PerformanceTestH
 
 #include <list>
+#include "PerformanceTimer.h"
 
 class PerformanceTestFunction
 {
@@ -49,6 +50,11 @@ class PerformanceTest
         static void registerTestFunction(const PerformanceTestFunction *testFunction);
         static void runAllTests();
 
+        // Called by a test function to exclude its preparation and cleanup
+        // from measured time
+        static void restartTimer();
+        static void stopTimer();
+
 
     private:
 
@@ -56,6 +62,8 @@ class PerformanceTest
         typedef TestList::iterator TestIterator;
 
         TestList registeredFunctions;
+        PerformanceTimer performanceTimer;
+        bool isTimerStopped;
 
         static PerformanceTest &getSingleInstance();
         void runSingleTest(const PerformanceTestFunction *testFunction);
@@ -0,0 +1,120 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "PerformanceTest.h"
+#include "PersistentMemoryPool.h"
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+
+const unsigned numberOfNodes = 4 * 1024 * 1024;
+const char *const fileName = "PersistentRestart.pool";
+
+namespace
+{
+    struct Node
+    {
+        std::uint32_t next;
+        std::uint32_t value;
+        std::uint32_t padding[6];
+    };
+}
+
+typedef PersistentMemoryPool<Node> NodePool;
+
+static void buildList(NodePool &pool)
+{
+    std::uint32_t head = INDEXED_MEMORY_POOL_NULL_INDEX;
+    for(unsigned index = 0; index < numberOfNodes; index++) {
+        Node *node = pool.allocateBlock();
+        node->next = head;
+        node->value = index;
+        head = pool.getIndex(node);
+    }
+
+    pool.setRootIndex(head);
+}
+
+// Drops the file from the page cache, as after reboot. Dirty pages have to be
+// written first, since only clean pages are evicted.
+static void evictFile()
+{
+#ifdef POSIX_FADV_DONTNEED
+    int fileDescriptor = ::open(fileName, O_RDONLY);
+    if(fileDescriptor >= 0) {
+        ::fdatasync(fileDescriptor);
+        ::posix_fadvise(fileDescriptor, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fileDescriptor);
+    }
+#endif
+}
+
+// Warm up after restart by building the structure from scratch
+PERFORMANCE_TEST(PersistentRestart, Rebuild)
+{
+    std::remove(fileName);
+
+    {
+        NodePool pool(fileName, numberOfNodes);
+        buildList(pool);
+    }
+
+    PerformanceTest::stopTimer();
+    std::remove(fileName);
+}
+
+// Warm up after restart by reopening the file and looking up a single node,
+// which loads only pages touched on the way. Only the reopen is measured.
+PERFORMANCE_TEST(PersistentRestart, Reopen)
+{
+    std::remove(fileName);
+
+    {
+        NodePool pool(fileName, numberOfNodes);
+        buildList(pool);
+        pool.flush();
+    }
+
+    evictFile();
+    PerformanceTest::restartTimer();
+
+    {
+        NodePool pool(fileName, numberOfNodes);
+
+        volatile std::uint32_t value = pool.getBlock(pool.getRootIndex())->value;
+        (void) value;
+    }
+
+    PerformanceTest::stopTimer();
+    std::remove(fileName);
+}
+
+#endif
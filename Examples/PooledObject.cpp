@@ -0,0 +1,96 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "PerformanceTest.h"
+#include "PooledObject.h"
+#include <vector>
+
+const unsigned numberOfIterations = 16 * 1024 * 1024;
+const unsigned numberOfLiveObjects = 1024;
+
+struct Order
+{
+    unsigned sequence;
+    unsigned quantity[5];
+
+    Order(unsigned sequence) :
+        sequence(sequence)
+    {
+    }
+};
+
+struct SharedPooledOrder : public Order, public PooledObject<SharedPooledOrder>
+{
+    SharedPooledOrder(unsigned sequence) :
+        Order(sequence)
+    {
+    }
+};
+
+struct ThreadLocalPooledOrder : public Order, public ThreadLocalPooledObject<ThreadLocalPooledOrder>
+{
+    ThreadLocalPooledOrder(unsigned sequence) :
+        Order(sequence)
+    {
+    }
+};
+
+// Each object is deleted when the object created numberOfLiveObjects later
+// takes its place
+template <class OrderType>
+static void createOrders()
+{
+    std::vector<OrderType *> orders(numberOfLiveObjects);
+
+    for(unsigned iteration = 0; iteration < numberOfIterations; iteration++) {
+        OrderType *&order = orders[iteration % numberOfLiveObjects];
+        delete order;
+        order = new OrderType(iteration);
+    }
+
+    for(unsigned index = 0; index < numberOfLiveObjects; index++)
+        delete orders[index];
+}
+
+PERFORMANCE_TEST(PooledObject, GlobalOperatorNew)
+{
+    createOrders<Order>();
+}
+
+PERFORMANCE_TEST(PooledObject, SharedObjectPool)
+{
+    createOrders<SharedPooledOrder>();
+}
+
+PERFORMANCE_TEST(PooledObject, ThreadLocalObjectPool)
+{
+    createOrders<ThreadLocalPooledOrder>();
+}
@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 
 #include "PerformanceTest.h"
 #include "MemoryPoolAllocator.h"
+#include "MemoryResource.h"
 #include <set>
 
 const unsigned numberOfIterations = 2 * 1024 * 1024;
@@ -40,6 +41,7 @@ typedef int DataType;
 typedef MemoryPoolAllocator<DataType> Allocator;
 typedef std::set<DataType> DefaultSet;
 typedef std::set<DataType, std::less<DataType>, Allocator> MemoryPoolSet;
+typedef std::pmr::set<DataType> MemoryResourceSet;
 
 PERFORMANCE_TEST(Set, DefaultAllocator)
 {
@@ -57,3 +59,21 @@ PERFORMANCE_TEST(Set, MemoryPoolAllocator)
     for(unsigned iteration = 0; iteration < numberOfIterations; iteration++)
         testSet.insert(iteration);
 }
+
+PERFORMANCE_TEST(Set, UnsynchronizedPoolResource)
+{
+    std::pmr::unsynchronized_pool_resource memoryResource;
+    MemoryResourceSet testSet(&memoryResource);
+
+    for(unsigned iteration = 0; iteration < numberOfIterations; iteration++)
+        testSet.insert(iteration);
+}
+
+PERFORMANCE_TEST(Set, PooledMemoryResource)
+{
+    UnsynchronizedPooledMemoryResource memoryResource(growByNumberOfElements);
+    MemoryResourceSet testSet(&memoryResource);
+
+    for(unsigned iteration = 0; iteration < numberOfIterations; iteration++)
+        testSet.insert(iteration);
+}
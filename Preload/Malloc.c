@@ -0,0 +1,461 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+/* Replacement of standard allocation functions to be loaded with LD_PRELOAD.
+   Blocks up to MAX_SIZE_CLASS_BLOCK_SIZE bytes are served by size-classed
+   memory pools, while bigger blocks are passed to the system allocator.
+
+   All pooled blocks come from a single reserved address range, split into
+   chunks assigned to size classes on demand, so ownership and size class of
+   any released block is found without any header. Each thread caches a few
+   free blocks of every size class, exchanged with shared memory pools in
+   batches. */
+
+#define _GNU_SOURCE
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "MemoryPool.h"
+#include "SizeClassAllocator.h"
+
+#define EXPORT __attribute__((visibility("default")))
+
+#define ARENA_SIZE ((size_t) 64 << 30)
+#define CHUNK_SHIFT 20
+#define CHUNK_SIZE ((size_t) 1 << CHUNK_SHIFT)
+#define NUMBER_OF_CHUNKS (ARENA_SIZE >> CHUNK_SHIFT)
+
+#define MAX_NUMBER_OF_SIZE_CLASSES 64
+#define BATCH_SIZE 32
+#define MAX_NUMBER_OF_CACHED_BLOCKS (2 * BATCH_SIZE)
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t number, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *pointer);
+
+struct ThreadCache
+{
+    struct MemoryPool memoryPools[MAX_NUMBER_OF_SIZE_CLASSES];
+    size_t numberOfCachedBlocks[MAX_NUMBER_OF_SIZE_CLASSES];
+    int isRegistered;
+    int isReleased;
+};
+
+static struct SizeClassAllocator sizeClassAllocator;
+static struct MemoryPool sharedMemoryPools[MAX_NUMBER_OF_SIZE_CLASSES];
+static pthread_mutex_t sharedMutexes[MAX_NUMBER_OF_SIZE_CLASSES];
+
+static uint8_t *arenaBase;
+static size_t numberOfUsedChunks;
+static uint8_t chunkSizeClass[NUMBER_OF_CHUNKS];
+
+static volatile int initializationState;
+static pthread_once_t initializationOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t threadCacheKey;
+
+static __thread struct ThreadCache threadCache __attribute__((tls_model("initial-exec")));
+
+static void releaseThreadCache(void *argument);
+
+static void initialize(void)
+{
+    size_t sizeClass;
+    uint8_t *reservation;
+
+    reservation = mmap(NULL, ARENA_SIZE + CHUNK_SIZE, PROT_NONE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if(reservation == MAP_FAILED || numberOfDefaultSizeClasses > MAX_NUMBER_OF_SIZE_CLASSES ||
+        pthread_key_create(&threadCacheKey, releaseThreadCache)) {
+        initializationState = -1;
+        return;
+    }
+
+    arenaBase = (uint8_t *) (((uintptr_t) reservation + CHUNK_SIZE - 1) & ~(CHUNK_SIZE - 1));
+
+    initializeSizeClassAllocator(&sizeClassAllocator, sharedMemoryPools,
+        defaultSizeClasses, numberOfDefaultSizeClasses);
+
+    for(sizeClass = 0; sizeClass < numberOfDefaultSizeClasses; sizeClass++)
+        pthread_mutex_init(&sharedMutexes[sizeClass], NULL);
+
+    initializationState = 1;
+}
+
+static int isInitialized(void)
+{
+    if(!initializationState)
+        pthread_once(&initializationOnce, initialize);
+
+    return initializationState > 0;
+}
+
+static int isArenaBlock(void *pointer)
+{
+    return arenaBase && (size_t) ((uint8_t *) pointer - arenaBase) < ARENA_SIZE;
+}
+
+static size_t getArenaBlockSizeClass(void *pointer)
+{
+    return chunkSizeClass[((uint8_t *) pointer - arenaBase) >> CHUNK_SHIFT];
+}
+
+static int allocateChunk(size_t sizeClass)
+{
+    struct MemoryPool *memoryPool = &sharedMemoryPools[sizeClass];
+    size_t chunkIndex;
+    uint8_t *chunk;
+
+    chunkIndex = __sync_fetch_and_add(&numberOfUsedChunks, 1);
+    if(chunkIndex >= NUMBER_OF_CHUNKS)
+        return 0;
+
+    chunk = arenaBase + (chunkIndex << CHUNK_SHIFT);
+    if(mprotect(chunk, CHUNK_SIZE, PROT_READ | PROT_WRITE))
+        return 0;
+
+    chunkSizeClass[chunkIndex] = (uint8_t) sizeClass;
+    initializeMemoryPool(memoryPool, chunk, CHUNK_SIZE / memoryPool->blockSize, memoryPool->blockSize);
+
+    return 1;
+}
+
+static void registerThreadCache(struct ThreadCache *cache)
+{
+    size_t sizeClass;
+
+    cache->isRegistered = 1;
+
+    for(sizeClass = 0; sizeClass < numberOfDefaultSizeClasses; sizeClass++)
+        cache->memoryPools[sizeClass].blockSize = sharedMemoryPools[sizeClass].blockSize;
+
+    pthread_setspecific(threadCacheKey, cache);
+}
+
+static void refillThreadCache(struct ThreadCache *cache, size_t sizeClass)
+{
+    struct MemoryPool *memoryPool = &sharedMemoryPools[sizeClass];
+    void *pointers[BATCH_SIZE];
+    size_t numberOfBlocks;
+
+    if(!cache->isRegistered)
+        registerThreadCache(cache);
+
+    pthread_mutex_lock(&sharedMutexes[sizeClass]);
+
+    numberOfBlocks = inlinedAllocateBlocks(memoryPool, pointers, BATCH_SIZE);
+    while(numberOfBlocks < BATCH_SIZE && allocateChunk(sizeClass)) {
+        numberOfBlocks += inlinedAllocateBlocks(memoryPool,
+            pointers + numberOfBlocks, BATCH_SIZE - numberOfBlocks);
+    }
+
+    pthread_mutex_unlock(&sharedMutexes[sizeClass]);
+
+    inlinedReleaseBlocks(&cache->memoryPools[sizeClass], pointers, numberOfBlocks);
+    cache->numberOfCachedBlocks[sizeClass] += numberOfBlocks;
+}
+
+static void flushThreadCache(struct ThreadCache *cache, size_t sizeClass, size_t numberOfBlocks)
+{
+    struct MemoryPool *memoryPool = &cache->memoryPools[sizeClass];
+    void *firstBlock;
+    void *lastBlock;
+    size_t i;
+
+    if(!numberOfBlocks)
+        return;
+
+    firstBlock = memoryPool->firstFreeBlock;
+    lastBlock = firstBlock;
+
+    for(i = 1; i < numberOfBlocks; i++)
+        lastBlock = *(void **) lastBlock;
+
+    memoryPool->firstFreeBlock = *(void **) lastBlock;
+    cache->numberOfCachedBlocks[sizeClass] -= numberOfBlocks;
+
+    pthread_mutex_lock(&sharedMutexes[sizeClass]);
+    inlinedReleaseBlockChain(&sharedMemoryPools[sizeClass], firstBlock, lastBlock, numberOfBlocks);
+    pthread_mutex_unlock(&sharedMutexes[sizeClass]);
+}
+
+/* Called at thread exit. Blocks allocated or released later, e.g. by other
+   destructors, bypass the thread cache, since registering it again could be
+   too late for another call of this function and its blocks would leak. */
+static void releaseThreadCache(void *argument)
+{
+    struct ThreadCache *cache = (struct ThreadCache *) argument;
+    size_t sizeClass;
+
+    for(sizeClass = 0; sizeClass < numberOfDefaultSizeClasses; sizeClass++)
+        flushThreadCache(cache, sizeClass, cache->numberOfCachedBlocks[sizeClass]);
+
+    cache->isRegistered = 0;
+    cache->isReleased = 1;
+}
+
+static void *allocateSharedBlock(size_t sizeClass)
+{
+    struct MemoryPool *memoryPool = &sharedMemoryPools[sizeClass];
+    void *pointer;
+
+    pthread_mutex_lock(&sharedMutexes[sizeClass]);
+
+    pointer = inlinedAllocateBlock(memoryPool);
+    if(!pointer && allocateChunk(sizeClass))
+        pointer = inlinedAllocateBlock(memoryPool);
+
+    pthread_mutex_unlock(&sharedMutexes[sizeClass]);
+
+    return pointer;
+}
+
+static void releaseSharedBlock(size_t sizeClass, void *pointer)
+{
+    pthread_mutex_lock(&sharedMutexes[sizeClass]);
+    inlinedReleaseBlock(&sharedMemoryPools[sizeClass], pointer);
+    pthread_mutex_unlock(&sharedMutexes[sizeClass]);
+}
+
+static void *allocateCachedBlock(size_t sizeClass)
+{
+    struct ThreadCache *cache = &threadCache;
+    void *pointer;
+
+    pointer = inlinedAllocateBlock(&cache->memoryPools[sizeClass]);
+    if(!pointer) {
+        if(cache->isReleased)
+            return allocateSharedBlock(sizeClass);
+
+        refillThreadCache(cache, sizeClass);
+
+        pointer = inlinedAllocateBlock(&cache->memoryPools[sizeClass]);
+        if(!pointer)
+            return NULL;
+    }
+
+    cache->numberOfCachedBlocks[sizeClass]--;
+    return pointer;
+}
+
+static void releaseCachedBlock(size_t sizeClass, void *pointer)
+{
+    struct ThreadCache *cache = &threadCache;
+
+    if(!cache->isRegistered) {
+        if(cache->isReleased) {
+            releaseSharedBlock(sizeClass, pointer);
+            return;
+        }
+
+        registerThreadCache(cache);
+    }
+
+    inlinedReleaseBlock(&cache->memoryPools[sizeClass], pointer);
+
+    if(++cache->numberOfCachedBlocks[sizeClass] > MAX_NUMBER_OF_CACHED_BLOCKS)
+        flushThreadCache(cache, sizeClass, BATCH_SIZE);
+}
+
+static void *allocateAlignedBlock(size_t alignment, size_t size)
+{
+    size_t sizeClass;
+    void *pointer;
+
+    if(size < alignment)
+        size = alignment;
+
+    /* Chunks are aligned to their size, so each block is aligned to the
+       biggest power of two dividing the block size. */
+    if(size <= MAX_SIZE_CLASS_BLOCK_SIZE && !(alignment & (alignment - 1)) && isInitialized()) {
+        sizeClass = inlinedGetSizeClass(&sizeClassAllocator, size);
+
+        if(!(sharedMemoryPools[sizeClass].blockSize & (alignment - 1))) {
+            pointer = allocateCachedBlock(sizeClass);
+            if(pointer)
+                return pointer;
+        }
+    }
+
+    return __libc_memalign(alignment, size);
+}
+
+static void lockSharedMemoryPools(void)
+{
+    size_t sizeClass;
+
+    for(sizeClass = 0; sizeClass < numberOfDefaultSizeClasses; sizeClass++)
+        pthread_mutex_lock(&sharedMutexes[sizeClass]);
+}
+
+static void unlockSharedMemoryPools(void)
+{
+    size_t sizeClass;
+
+    for(sizeClass = 0; sizeClass < numberOfDefaultSizeClasses; sizeClass++)
+        pthread_mutex_unlock(&sharedMutexes[sizeClass]);
+}
+
+static void __attribute__((constructor)) registerForkHandlers(void)
+{
+    if(isInitialized())
+        pthread_atfork(lockSharedMemoryPools, unlockSharedMemoryPools, unlockSharedMemoryPools);
+}
+
+EXPORT void *malloc(size_t size)
+{
+    void *pointer;
+
+    if(size <= MAX_SIZE_CLASS_BLOCK_SIZE && isInitialized()) {
+        pointer = allocateCachedBlock(inlinedGetSizeClass(&sizeClassAllocator, size));
+        if(pointer)
+            return pointer;
+    }
+
+    return __libc_malloc(size);
+}
+
+EXPORT void free(void *pointer)
+{
+    if(!pointer)
+        return;
+
+    if(isArenaBlock(pointer))
+        releaseCachedBlock(getArenaBlockSizeClass(pointer), pointer);
+    else
+        __libc_free(pointer);
+}
+
+EXPORT void *calloc(size_t number, size_t size)
+{
+    void *pointer;
+
+    if(size && number > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    size *= number;
+
+    if(size <= MAX_SIZE_CLASS_BLOCK_SIZE && isInitialized()) {
+        pointer = allocateCachedBlock(inlinedGetSizeClass(&sizeClassAllocator, size));
+        if(pointer)
+            return memset(pointer, 0, size);
+    }
+
+    return __libc_calloc(1, size);
+}
+
+EXPORT void *realloc(void *pointer, size_t size)
+{
+    size_t blockSize;
+    void *newPointer;
+
+    if(!pointer)
+        return malloc(size);
+
+    if(!isArenaBlock(pointer))
+        return __libc_realloc(pointer, size);
+
+    if(!size) {
+        free(pointer);
+        return NULL;
+    }
+
+    blockSize = sharedMemoryPools[getArenaBlockSizeClass(pointer)].blockSize;
+    if(size <= blockSize)
+        return pointer;
+
+    newPointer = malloc(size);
+    if(newPointer) {
+        memcpy(newPointer, pointer, blockSize);
+        free(pointer);
+    }
+
+    return newPointer;
+}
+
+EXPORT void *reallocarray(void *pointer, size_t number, size_t size)
+{
+    if(size && number > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    return realloc(pointer, number * size);
+}
+
+EXPORT int posix_memalign(void **pointer, size_t alignment, size_t size)
+{
+    void *newPointer;
+
+    if(!alignment || (alignment & (alignment - 1)) || (alignment % sizeof(void *)))
+        return EINVAL;
+
+    newPointer = allocateAlignedBlock(alignment, size);
+    if(!newPointer)
+        return ENOMEM;
+
+    *pointer = newPointer;
+    return 0;
+}
+
+EXPORT void *memalign(size_t alignment, size_t size)
+{
+    return allocateAlignedBlock(alignment, size);
+}
+
+EXPORT void *aligned_alloc(size_t alignment, size_t size)
+{
+    return allocateAlignedBlock(alignment, size);
+}
+
+EXPORT size_t malloc_usable_size(void *pointer)
+{
+    static size_t (*systemMallocUsableSize)(void *);
+
+    if(!pointer)
+        return 0;
+
+    if(isArenaBlock(pointer))
+        return sharedMemoryPools[getArenaBlockSizeClass(pointer)].blockSize;
+
+    if(!systemMallocUsableSize)
+        *(void **) &systemMallocUsableSize = dlsym(RTLD_NEXT, "malloc_usable_size");
+
+    return systemMallocUsableSize ? systemMallocUsableSize(pointer) : 0;
+}
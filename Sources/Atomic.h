@@ -0,0 +1,188 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef AtomicH
+#define AtomicH
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Inline.h"
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+#if defined(_MSC_VER)
+    #if defined(_WIN64)
+        #define ATOMIC_PAIR_ALIGNMENT __declspec(align(16))
+    #else
+        #define ATOMIC_PAIR_ALIGNMENT __declspec(align(8))
+    #endif
+#elif defined(__GNUC__)
+    #define ATOMIC_PAIR_ALIGNMENT __attribute__((aligned(2 * sizeof(void *))))
+#else
+    #error Unsupported compiler
+#endif
+
+/* Two machine words modified together by a single compare-and-swap. The tag
+   is either a modification counter protecting the pointer against ABA
+   problem, or any other value which must change together with the pointer. */
+struct ATOMIC_PAIR_ALIGNMENT TaggedPointer
+{
+    void *pointer;
+    uintptr_t tag;
+};
+
+#if defined(__GNUC__)
+    #if defined(__SIZEOF_INT128__) && (__SIZEOF_POINTER__ == 8)
+        __extension__ typedef unsigned __int128 AtomicDoubleWord;
+    #else
+        typedef uint64_t AtomicDoubleWord;
+    #endif
+
+    union TaggedPointerWord
+    {
+        struct TaggedPointer taggedPointer;
+        AtomicDoubleWord word;
+    };
+#endif
+
+/* Both words are read separately. Torn value may be observed, but it is always
+   rejected by following compare-and-swap, since it never matches the target. */
+INLINE void atomicLoadTaggedPointer(struct TaggedPointer *target,
+    struct TaggedPointer *result)
+{
+    result->tag = ((volatile struct TaggedPointer *) target)->tag;
+    result->pointer = ((volatile struct TaggedPointer *) target)->pointer;
+}
+
+/* Returns non-zero when target was equal to expected and has been replaced
+   with desired. Otherwise expected is updated with the current target value. */
+INLINE int atomicCompareExchangeTaggedPointer(struct TaggedPointer *target,
+    struct TaggedPointer *expected, const struct TaggedPointer *desired)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+    return _InterlockedCompareExchange128((volatile __int64 *) target,
+        (__int64) desired->tag, (__int64) desired->pointer, (__int64 *) expected);
+#elif defined(_MSC_VER)
+    __int64 previous;
+    __int64 comparand = *(__int64 *) expected;
+
+    previous = _InterlockedCompareExchange64((volatile __int64 *) target,
+        *(const __int64 *) desired, comparand);
+    if(previous == comparand)
+        return 1;
+
+    *(__int64 *) expected = previous;
+    return 0;
+#else
+    union TaggedPointerWord previous;
+    union TaggedPointerWord comparand;
+    union TaggedPointerWord exchange;
+
+    comparand.taggedPointer = *expected;
+    exchange.taggedPointer = *desired;
+
+    previous.word = __sync_val_compare_and_swap((AtomicDoubleWord *) target,
+        comparand.word, exchange.word);
+    if(previous.word == comparand.word)
+        return 1;
+
+    *expected = previous.taggedPointer;
+    return 0;
+#endif
+}
+
+/* Returns non-zero when target was equal to expected and has been replaced
+   with desired. */
+INLINE int atomicCompareExchangePointer(void *volatile *target,
+    void *expected, void *desired)
+{
+#if defined(_MSC_VER)
+    return _InterlockedCompareExchangePointer(target, desired, expected) == expected;
+#else
+    return __sync_bool_compare_and_swap(target, expected, desired);
+#endif
+}
+
+/* Returns non-zero when target was equal to expected and has been replaced
+   with desired. */
+INLINE int atomicCompareExchangeWord(volatile uintptr_t *target,
+    uintptr_t expected, uintptr_t desired)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+    return _InterlockedCompareExchange64((volatile __int64 *) target,
+        (__int64) desired, (__int64) expected) == (__int64) expected;
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchange((volatile long *) target,
+        (long) desired, (long) expected) == (long) expected;
+#else
+    return __sync_bool_compare_and_swap(target, expected, desired);
+#endif
+}
+
+/* Returns non-zero when target was equal to expected and has been replaced
+   with desired. Suitable for memory shared between processes as well. */
+INLINE int atomicCompareExchange64(volatile uint64_t *target,
+    uint64_t expected, uint64_t desired)
+{
+#if defined(_MSC_VER)
+    return _InterlockedCompareExchange64((volatile __int64 *) target,
+        (__int64) desired, (__int64) expected) == (__int64) expected;
+#else
+    return __sync_bool_compare_and_swap(target, expected, desired);
+#endif
+}
+
+/* Stores desired in target and returns its previous value. It acquires
+   everything released by compare-and-swap on the same target. */
+INLINE void *atomicExchangePointer(void *volatile *target, void *desired)
+{
+#if defined(_MSC_VER)
+    return _InterlockedExchangePointer(target, desired);
+#else
+    return __sync_lock_test_and_set(target, desired);
+#endif
+}
+
+/* Orders all memory accesses before the barrier with all accesses after it */
+INLINE void atomicFullBarrier(void)
+{
+#if defined(_MSC_VER)
+    volatile long barrier = 0;
+    _InterlockedOr(&barrier, 0);
+#else
+    __sync_synchronize();
+#endif
+}
+
+#endif
@@ -0,0 +1,188 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef BitmapMemoryPoolH
+#define BitmapMemoryPoolH
+
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "Inline.h"
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+#define BITMAP_WORD_BITS (sizeof(size_t) * CHAR_BIT)
+
+/* Each block is tracked by single bit of the bitmap, set when block is free, so
+   blocks of any size, even single byte, can be allocated. Memory region holds
+   the bitmap followed by blocks, and it must be aligned to size_t. */
+struct BitmapMemoryPool
+{
+    size_t blockSize;
+    size_t numberOfBlocks;
+    size_t numberOfFreeBlocks;
+    size_t firstFreeWord;
+    size_t *bitmap;
+    uint8_t *blocks;
+};
+
+INLINE size_t inlinedCountTrailingZeros(size_t word)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, word);
+    return index;
+#elif defined(__GNUC__) && SIZE_MAX == ULONG_MAX
+    return __builtin_ctzl(word);
+#else
+    size_t index = 0;
+
+    while(!(word & 1)) {
+        word >>= 1;
+        index++;
+    }
+
+    return index;
+#endif
+}
+
+INLINE size_t inlinedGetNumberOfBitmapWords(size_t numberOfBlocks)
+{
+    return (numberOfBlocks + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS;
+}
+
+INLINE size_t inlinedGetBitmapMemoryRegionSize(size_t numberOfBlocks, size_t blockSize)
+{
+    return inlinedGetNumberOfBitmapWords(numberOfBlocks) * sizeof(size_t) +
+        numberOfBlocks * blockSize;
+}
+
+INLINE void inlinedInitializeBitmapMemoryPool(struct BitmapMemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t blockSize)
+{
+    size_t numberOfWords;
+    size_t word;
+
+    if(!blockSize || !memoryRegion)
+        numberOfBlocks = 0;
+
+    numberOfWords = inlinedGetNumberOfBitmapWords(numberOfBlocks);
+
+    memoryPool->blockSize = blockSize;
+    memoryPool->numberOfBlocks = numberOfBlocks;
+    memoryPool->numberOfFreeBlocks = numberOfBlocks;
+    memoryPool->firstFreeWord = 0;
+    memoryPool->bitmap = (size_t *) memoryRegion;
+    memoryPool->blocks = (uint8_t *) memoryRegion + numberOfWords * sizeof(size_t);
+
+    for(word = 0; word < numberOfWords; word++)
+        memoryPool->bitmap[word] = ~(size_t) 0;
+
+    /* Bits beyond the last block are never set */
+    if(numberOfBlocks % BITMAP_WORD_BITS)
+        memoryPool->bitmap[numberOfWords - 1] =
+            ((size_t) 1 << (numberOfBlocks % BITMAP_WORD_BITS)) - 1;
+}
+
+/* Free block of the lowest address is allocated first, which keeps allocated
+   blocks packed at the beginning of the memory region. */
+INLINE void *inlinedAllocateBitmapBlock(struct BitmapMemoryPool *memoryPool)
+{
+    size_t word;
+    size_t bits;
+    size_t index;
+
+    if(!memoryPool->numberOfFreeBlocks)
+        return NULL;
+
+    /* No word before firstFreeWord has free blocks, and some word after has */
+    word = memoryPool->firstFreeWord;
+    while(!memoryPool->bitmap[word])
+        word++;
+
+    bits = memoryPool->bitmap[word];
+    memoryPool->bitmap[word] = bits & (bits - 1);
+    memoryPool->firstFreeWord = word;
+    memoryPool->numberOfFreeBlocks--;
+
+    index = word * BITMAP_WORD_BITS + inlinedCountTrailingZeros(bits);
+    return memoryPool->blocks + index * memoryPool->blockSize;
+}
+
+INLINE void inlinedReleaseBitmapBlock(struct BitmapMemoryPool *memoryPool, void *pointer)
+{
+    size_t index;
+    size_t word;
+
+    index = (size_t) ((uint8_t *) pointer - memoryPool->blocks) / memoryPool->blockSize;
+    word = index / BITMAP_WORD_BITS;
+
+    memoryPool->bitmap[word] |= (size_t) 1 << (index % BITMAP_WORD_BITS);
+    memoryPool->numberOfFreeBlocks++;
+
+    if(word < memoryPool->firstFreeWord)
+        memoryPool->firstFreeWord = word;
+}
+
+INLINE int inlinedIsBitmapBlockAllocated(const struct BitmapMemoryPool *memoryPool,
+    const void *pointer)
+{
+    size_t index;
+
+    index = (size_t) ((const uint8_t *) pointer - memoryPool->blocks) / memoryPool->blockSize;
+    return !(memoryPool->bitmap[index / BITMAP_WORD_BITS] & ((size_t) 1 << (index % BITMAP_WORD_BITS)));
+}
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+    void initializeBitmapMemoryPool(struct BitmapMemoryPool *memoryPool,
+        void *memoryRegion, size_t numberOfBlocks, size_t blockSize);
+    size_t getBitmapMemoryRegionSize(size_t numberOfBlocks, size_t blockSize);
+
+    void *allocateBitmapBlock(struct BitmapMemoryPool *memoryPool);
+    void releaseBitmapBlock(struct BitmapMemoryPool *memoryPool, void *pointer);
+    int isBitmapBlockAllocated(const struct BitmapMemoryPool *memoryPool,
+        const void *pointer);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
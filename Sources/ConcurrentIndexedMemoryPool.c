@@ -0,0 +1,72 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "ConcurrentIndexedMemoryPool.h"
+
+void initializeConcurrentIndexedMemoryPool(struct ConcurrentIndexedMemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t blockSize)
+{
+    inlinedInitializeConcurrentIndexedMemoryPool(memoryPool, memoryRegion, numberOfBlocks, blockSize);
+}
+
+void *getConcurrentIndexedBlock(const struct ConcurrentIndexedMemoryPool *memoryPool,
+    uint32_t index)
+{
+    return inlinedGetConcurrentIndexedBlock(memoryPool, index);
+}
+
+uint32_t getIndexOfConcurrentIndexedBlock(const struct ConcurrentIndexedMemoryPool *memoryPool,
+    const void *pointer)
+{
+    return inlinedGetIndexOfConcurrentIndexedBlock(memoryPool, pointer);
+}
+
+uint32_t allocateIndexedBlockIndexConcurrent(struct ConcurrentIndexedMemoryPool *memoryPool)
+{
+    return inlinedAllocateIndexedBlockIndexConcurrent(memoryPool);
+}
+
+void releaseIndexedBlockIndexConcurrent(struct ConcurrentIndexedMemoryPool *memoryPool,
+    uint32_t index)
+{
+    inlinedReleaseIndexedBlockIndexConcurrent(memoryPool, index);
+}
+
+void *allocateIndexedBlockConcurrent(struct ConcurrentIndexedMemoryPool *memoryPool)
+{
+    return inlinedAllocateIndexedBlockConcurrent(memoryPool);
+}
+
+void releaseIndexedBlockConcurrent(struct ConcurrentIndexedMemoryPool *memoryPool,
+    void *pointer)
+{
+    inlinedReleaseIndexedBlockConcurrent(memoryPool, pointer);
+}
@@ -0,0 +1,180 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef ConcurrentIndexedMemoryPoolH
+#define ConcurrentIndexedMemoryPoolH
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Inline.h"
+#include "Atomic.h"
+#include "IndexedMemoryPool.h"
+
+/* Lock-free equivalent of IndexedMemoryPool, which holds no pointers. The
+   memory region is referred by offset relative to the memory pool itself, so
+   both can be placed in memory shared between processes and mapped at
+   different addresses. Head of the list of free blocks is a 64-bit word with
+   index of the block in lower half and modification counter, protecting
+   against ABA problem, in upper half. */
+struct ConcurrentIndexedMemoryPool
+{
+    volatile uint64_t firstFreeBlock;
+    volatile uint64_t firstNotYetUsedBlock;
+    uint32_t numberOfBlocks;
+    uint32_t blockSize;
+    int64_t memoryRegionOffset;
+};
+
+#define CONCURRENT_INDEXED_MEMORY_POOL_TAG_UNIT (((uint64_t) 1) << 32)
+
+INLINE void inlinedInitializeConcurrentIndexedMemoryPool(struct ConcurrentIndexedMemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t blockSize)
+{
+    if(!memoryRegion)
+        numberOfBlocks = 0;
+
+    /* Last index is reserved for INDEXED_MEMORY_POOL_NULL_INDEX */
+    if(numberOfBlocks > INDEXED_MEMORY_POOL_NULL_INDEX)
+        numberOfBlocks = INDEXED_MEMORY_POOL_NULL_INDEX;
+
+    blockSize = (blockSize + MIN_INDEXED_MEMORY_POOL_BLOCK_SIZE - 1) & ~(MIN_INDEXED_MEMORY_POOL_BLOCK_SIZE - 1);
+    if(!blockSize)
+        blockSize = MIN_INDEXED_MEMORY_POOL_BLOCK_SIZE;
+
+    memoryPool->firstFreeBlock = INDEXED_MEMORY_POOL_NULL_INDEX;
+    memoryPool->firstNotYetUsedBlock = 0;
+    memoryPool->numberOfBlocks = (uint32_t) numberOfBlocks;
+    memoryPool->blockSize = (uint32_t) blockSize;
+    memoryPool->memoryRegionOffset = (int64_t) ((uint8_t *) memoryRegion - (uint8_t *) memoryPool);
+}
+
+INLINE void *inlinedGetConcurrentIndexedBlock(const struct ConcurrentIndexedMemoryPool *memoryPool,
+    uint32_t index)
+{
+    return (uint8_t *) memoryPool + memoryPool->memoryRegionOffset +
+        (size_t) index * memoryPool->blockSize;
+}
+
+INLINE uint32_t inlinedGetIndexOfConcurrentIndexedBlock(const struct ConcurrentIndexedMemoryPool *memoryPool,
+    const void *pointer)
+{
+    return (uint32_t) ((size_t) ((const uint8_t *) pointer -
+        ((const uint8_t *) memoryPool + memoryPool->memoryRegionOffset)) / memoryPool->blockSize);
+}
+
+/* Returns index of allocated block or INDEXED_MEMORY_POOL_NULL_INDEX when none is available */
+INLINE uint32_t inlinedAllocateIndexedBlockIndexConcurrent(struct ConcurrentIndexedMemoryPool *memoryPool)
+{
+    uint64_t expected;
+    uint64_t desired;
+    uint32_t index;
+
+    for(;;) {
+        expected = memoryPool->firstFreeBlock;
+        index = (uint32_t) expected;
+        if(index == INDEXED_MEMORY_POOL_NULL_INDEX)
+            break;
+
+        /* The block may be already allocated by other thread, in which case
+           read index is garbage, but compare-and-swap fails due to the tag */
+        desired = (expected & ~(uint64_t) INDEXED_MEMORY_POOL_NULL_INDEX) + CONCURRENT_INDEXED_MEMORY_POOL_TAG_UNIT;
+        desired |= *(volatile uint32_t *) inlinedGetConcurrentIndexedBlock(memoryPool, index);
+
+        if(atomicCompareExchange64(&memoryPool->firstFreeBlock, expected, desired))
+            return index;
+    }
+
+    for(;;) {
+        expected = memoryPool->firstNotYetUsedBlock;
+        if(expected >= memoryPool->numberOfBlocks)
+            return INDEXED_MEMORY_POOL_NULL_INDEX;
+
+        if(atomicCompareExchange64(&memoryPool->firstNotYetUsedBlock, expected, expected + 1))
+            return (uint32_t) expected;
+    }
+}
+
+INLINE void inlinedReleaseIndexedBlockIndexConcurrent(struct ConcurrentIndexedMemoryPool *memoryPool,
+    uint32_t index)
+{
+    uint64_t expected;
+    uint64_t desired;
+
+    do {
+        expected = memoryPool->firstFreeBlock;
+        *(volatile uint32_t *) inlinedGetConcurrentIndexedBlock(memoryPool, index) = (uint32_t) expected;
+        desired = ((expected & ~(uint64_t) INDEXED_MEMORY_POOL_NULL_INDEX) + CONCURRENT_INDEXED_MEMORY_POOL_TAG_UNIT) | index;
+    } while(!atomicCompareExchange64(&memoryPool->firstFreeBlock, expected, desired));
+}
+
+INLINE void *inlinedAllocateIndexedBlockConcurrent(struct ConcurrentIndexedMemoryPool *memoryPool)
+{
+    uint32_t index = inlinedAllocateIndexedBlockIndexConcurrent(memoryPool);
+
+    if(index == INDEXED_MEMORY_POOL_NULL_INDEX)
+        return NULL;
+
+    return inlinedGetConcurrentIndexedBlock(memoryPool, index);
+}
+
+INLINE void inlinedReleaseIndexedBlockConcurrent(struct ConcurrentIndexedMemoryPool *memoryPool,
+    void *pointer)
+{
+    inlinedReleaseIndexedBlockIndexConcurrent(memoryPool,
+        inlinedGetIndexOfConcurrentIndexedBlock(memoryPool, pointer));
+}
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+    void initializeConcurrentIndexedMemoryPool(struct ConcurrentIndexedMemoryPool *memoryPool,
+        void *memoryRegion, size_t numberOfBlocks, size_t blockSize);
+
+    void *getConcurrentIndexedBlock(const struct ConcurrentIndexedMemoryPool *memoryPool,
+        uint32_t index);
+    uint32_t getIndexOfConcurrentIndexedBlock(const struct ConcurrentIndexedMemoryPool *memoryPool,
+        const void *pointer);
+
+    uint32_t allocateIndexedBlockIndexConcurrent(struct ConcurrentIndexedMemoryPool *memoryPool);
+    void releaseIndexedBlockIndexConcurrent(struct ConcurrentIndexedMemoryPool *memoryPool,
+        uint32_t index);
+
+    void *allocateIndexedBlockConcurrent(struct ConcurrentIndexedMemoryPool *memoryPool);
+    void releaseIndexedBlockConcurrent(struct ConcurrentIndexedMemoryPool *memoryPool,
+        void *pointer);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
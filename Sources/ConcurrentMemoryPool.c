@@ -0,0 +1,60 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "ConcurrentMemoryPool.h"
+
+void initializeConcurrentMemoryPool(struct ConcurrentMemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t blockSize)
+{
+    inlinedInitializeConcurrentMemoryPool(memoryPool, memoryRegion, numberOfBlocks, blockSize);
+}
+
+int extendConcurrentMemoryPool(struct ConcurrentMemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks)
+{
+    return inlinedExtendConcurrentMemoryPool(memoryPool, memoryRegion, numberOfBlocks);
+}
+
+void *allocateBlockConcurrent(struct ConcurrentMemoryPool *memoryPool)
+{
+    return inlinedAllocateBlockConcurrent(memoryPool);
+}
+
+void releaseBlockConcurrent(struct ConcurrentMemoryPool *memoryPool, void *pointer)
+{
+    inlinedReleaseBlockConcurrent(memoryPool, pointer);
+}
+
+void releaseBlocksConcurrent(struct ConcurrentMemoryPool *memoryPool,
+    void **pointers, size_t numberOfBlocks)
+{
+    inlinedReleaseBlocksConcurrent(memoryPool, pointers, numberOfBlocks);
+}
@@ -0,0 +1,167 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef ConcurrentMemoryPoolH
+#define ConcurrentMemoryPoolH
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Inline.h"
+#include "Atomic.h"
+#include "MemoryPool.h"
+
+/* Lock-free equivalent of MemoryPool. List of free blocks is a Treiber stack
+   with head pointer tagged by modification counter, while not yet used blocks
+   are described by pointer tagged with number of blocks left. */
+struct ConcurrentMemoryPool
+{
+    struct TaggedPointer firstFreeBlock;
+    struct TaggedPointer notYetUsedBlocks;
+    size_t blockSize;
+};
+
+INLINE void inlinedInitializeConcurrentMemoryPool(struct ConcurrentMemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t blockSize)
+{
+    if(blockSize < MIN_MEMORY_POOL_BLOCK_SIZE)
+        numberOfBlocks = 0;
+
+    memoryPool->blockSize = blockSize;
+    memoryPool->notYetUsedBlocks.pointer = memoryRegion;
+    memoryPool->notYetUsedBlocks.tag = numberOfBlocks;
+    memoryPool->firstFreeBlock.pointer = NULL;
+    memoryPool->firstFreeBlock.tag = 0;
+}
+
+INLINE int inlinedExtendConcurrentMemoryPool(struct ConcurrentMemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks)
+{
+    struct TaggedPointer expected;
+    struct TaggedPointer desired;
+
+    if(memoryPool->blockSize < MIN_MEMORY_POOL_BLOCK_SIZE)
+        numberOfBlocks = 0;
+
+    desired.pointer = memoryRegion;
+    desired.tag = numberOfBlocks;
+
+    atomicLoadTaggedPointer(&memoryPool->notYetUsedBlocks, &expected);
+    while(!expected.tag) {
+        if(atomicCompareExchangeTaggedPointer(&memoryPool->notYetUsedBlocks, &expected, &desired))
+            return 1;
+    }
+
+    return 0;
+}
+
+INLINE void *inlinedAllocateBlockConcurrent(struct ConcurrentMemoryPool *memoryPool)
+{
+    struct TaggedPointer expected;
+    struct TaggedPointer desired;
+
+    atomicLoadTaggedPointer(&memoryPool->firstFreeBlock, &expected);
+    while(expected.pointer) {
+        desired.pointer = *(void *volatile *) expected.pointer;
+        desired.tag = expected.tag + 1;
+
+        if(atomicCompareExchangeTaggedPointer(&memoryPool->firstFreeBlock, &expected, &desired))
+            return expected.pointer;
+    }
+
+    atomicLoadTaggedPointer(&memoryPool->notYetUsedBlocks, &expected);
+    while(expected.tag) {
+        desired.pointer = ((uint8_t *) expected.pointer) + memoryPool->blockSize;
+        desired.tag = expected.tag - 1;
+
+        if(atomicCompareExchangeTaggedPointer(&memoryPool->notYetUsedBlocks, &expected, &desired))
+            return expected.pointer;
+    }
+
+    return NULL;
+}
+
+INLINE void inlinedReleaseBlockConcurrent(struct ConcurrentMemoryPool *memoryPool, void *pointer)
+{
+    struct TaggedPointer expected;
+    struct TaggedPointer desired;
+
+    desired.pointer = pointer;
+
+    atomicLoadTaggedPointer(&memoryPool->firstFreeBlock, &expected);
+    do {
+        *(void *volatile *) pointer = expected.pointer;
+        desired.tag = expected.tag + 1;
+    } while(!atomicCompareExchangeTaggedPointer(&memoryPool->firstFreeBlock, &expected, &desired));
+}
+
+/* Links blocks together and pushes all of them by single compare-and-swap */
+INLINE void inlinedReleaseBlocksConcurrent(struct ConcurrentMemoryPool *memoryPool,
+    void **pointers, size_t numberOfBlocks)
+{
+    struct TaggedPointer expected;
+    struct TaggedPointer desired;
+    size_t i;
+
+    if(!numberOfBlocks)
+        return;
+
+    for(i = 1; i < numberOfBlocks; i++)
+        *(void **) pointers[i - 1] = pointers[i];
+
+    desired.pointer = pointers[0];
+
+    atomicLoadTaggedPointer(&memoryPool->firstFreeBlock, &expected);
+    do {
+        *(void *volatile *) pointers[numberOfBlocks - 1] = expected.pointer;
+        desired.tag = expected.tag + 1;
+    } while(!atomicCompareExchangeTaggedPointer(&memoryPool->firstFreeBlock, &expected, &desired));
+}
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+    void initializeConcurrentMemoryPool(struct ConcurrentMemoryPool *memoryPool,
+        void *memoryRegion, size_t numberOfBlocks, size_t blockSize);
+    int extendConcurrentMemoryPool(struct ConcurrentMemoryPool *memoryPool,
+        void *memoryRegion, size_t numberOfBlocks);
+
+    void *allocateBlockConcurrent(struct ConcurrentMemoryPool *memoryPool);
+    void releaseBlockConcurrent(struct ConcurrentMemoryPool *memoryPool, void *pointer);
+    void releaseBlocksConcurrent(struct ConcurrentMemoryPool *memoryPool,
+        void **pointers, size_t numberOfBlocks);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
@@ -0,0 +1,226 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef EpochReclamationH
+#define EpochReclamationH
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Inline.h"
+#include "Atomic.h"
+
+/* Epoch-based reclamation of blocks removed from lock-free structures, which
+   may be still accessed by concurrent readers. Readers access such structures
+   within critical sections only. A block retired during an epoch is safe to
+   reuse once the global epoch has advanced twice, since it requires every
+   thread to leave critical sections entered before the block was retired. */
+struct EpochDomain
+{
+    volatile uintptr_t epoch;
+    struct EpochParticipant *volatile firstParticipant;
+};
+
+/* Participant is used by single thread at a time. Its retired blocks are kept
+   in the array given on initialization, ordered by epoch of retirement, so
+   memory of retired blocks is not touched until they are safe to reuse. */
+struct EpochParticipant
+{
+    struct EpochParticipant *nextParticipant;
+    /* Observed epoch shifted left, with the lowest bit set in critical section */
+    volatile uintptr_t state;
+    size_t nestingLevel;
+    uintptr_t currentEpoch;
+    size_t numberOfCurrentBlocks;
+    size_t numberOfPreviousBlocks;
+    void **retiredBlocks;
+    size_t numberOfRetiredBlocks;
+    size_t maxNumberOfRetiredBlocks;
+};
+
+INLINE void inlinedInitializeEpochDomain(struct EpochDomain *epochDomain)
+{
+    epochDomain->epoch = 0;
+    epochDomain->firstParticipant = NULL;
+}
+
+INLINE void inlinedInitializeEpochParticipant(struct EpochParticipant *participant,
+    void **retiredBlocks, size_t maxNumberOfRetiredBlocks)
+{
+    participant->nextParticipant = NULL;
+    participant->state = 0;
+    participant->nestingLevel = 0;
+    participant->currentEpoch = 0;
+    participant->numberOfCurrentBlocks = 0;
+    participant->numberOfPreviousBlocks = 0;
+    participant->retiredBlocks = retiredBlocks;
+    participant->numberOfRetiredBlocks = 0;
+    participant->maxNumberOfRetiredBlocks = maxNumberOfRetiredBlocks;
+}
+
+/* Participants are never removed from the domain. Participant, which is not in
+   critical section, does not hold back the epoch, so it can be left unused or
+   handed over to other thread. */
+INLINE void inlinedAddEpochParticipant(struct EpochDomain *epochDomain,
+    struct EpochParticipant *participant)
+{
+    do {
+        participant->nextParticipant = epochDomain->firstParticipant;
+    } while(!atomicCompareExchangePointer((void *volatile *) &epochDomain->firstParticipant,
+        participant->nextParticipant, participant));
+}
+
+/* Critical sections may be nested */
+INLINE void inlinedEnterEpoch(struct EpochDomain *epochDomain,
+    struct EpochParticipant *participant)
+{
+    if(participant->nestingLevel++)
+        return;
+
+    participant->state = (epochDomain->epoch << 1) | 1;
+    atomicFullBarrier();
+}
+
+INLINE void inlinedLeaveEpoch(struct EpochParticipant *participant)
+{
+    if(--participant->nestingLevel)
+        return;
+
+    atomicFullBarrier();
+    participant->state &= ~(uintptr_t) 1;
+}
+
+/* Returns non-zero when the global epoch has been advanced, by this or other
+   thread. It fails while any participant stays in critical section entered
+   during a previous epoch. */
+INLINE int inlinedAdvanceEpoch(struct EpochDomain *epochDomain)
+{
+    struct EpochParticipant *participant;
+    uintptr_t epoch = epochDomain->epoch;
+    uintptr_t state;
+
+    atomicFullBarrier();
+
+    for(participant = epochDomain->firstParticipant; participant;
+        participant = participant->nextParticipant) {
+        state = participant->state;
+        if((state & 1) && (state >> 1) != epoch)
+            return 0;
+    }
+
+    atomicCompareExchangeWord(&epochDomain->epoch, epoch, epoch + 1);
+    return 1;
+}
+
+/* Blocks retired before the previous epoch become safe to reuse */
+INLINE void inlinedObserveEpoch(struct EpochParticipant *participant, uintptr_t epoch)
+{
+    if(epoch == participant->currentEpoch)
+        return;
+
+    if(epoch == participant->currentEpoch + 1)
+        participant->numberOfPreviousBlocks = participant->numberOfCurrentBlocks;
+    else
+        participant->numberOfPreviousBlocks = 0;
+
+    participant->currentEpoch = epoch;
+    participant->numberOfCurrentBlocks = 0;
+}
+
+/* Block must be already unreachable for readers, which enter critical section
+   from now on. Returns zero when there is no space left for the block, in
+   which case safe blocks have to be collected first. */
+INLINE int inlinedRetireBlock(struct EpochDomain *epochDomain,
+    struct EpochParticipant *participant, void *pointer)
+{
+    if(participant->numberOfRetiredBlocks == participant->maxNumberOfRetiredBlocks)
+        return 0;
+
+    inlinedObserveEpoch(participant, epochDomain->epoch);
+
+    participant->retiredBlocks[participant->numberOfRetiredBlocks++] = pointer;
+    participant->numberOfCurrentBlocks++;
+
+    return 1;
+}
+
+/* Tries to advance the global epoch and moves up to maxNumberOfBlocks retired
+   blocks, which are safe to reuse, to the pointers array. Returns number of
+   moved blocks. */
+INLINE size_t inlinedCollectRetiredBlocks(struct EpochDomain *epochDomain,
+    struct EpochParticipant *participant, void **pointers, size_t maxNumberOfBlocks)
+{
+    size_t numberOfBlocks;
+
+    inlinedAdvanceEpoch(epochDomain);
+    inlinedObserveEpoch(participant, epochDomain->epoch);
+
+    numberOfBlocks = participant->numberOfRetiredBlocks -
+        participant->numberOfPreviousBlocks - participant->numberOfCurrentBlocks;
+    if(numberOfBlocks > maxNumberOfBlocks)
+        numberOfBlocks = maxNumberOfBlocks;
+
+    if(!numberOfBlocks)
+        return 0;
+
+    memcpy(pointers, participant->retiredBlocks, numberOfBlocks * sizeof(void *));
+    participant->numberOfRetiredBlocks -= numberOfBlocks;
+    memmove(participant->retiredBlocks, participant->retiredBlocks + numberOfBlocks,
+        participant->numberOfRetiredBlocks * sizeof(void *));
+
+    return numberOfBlocks;
+}
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+    void initializeEpochDomain(struct EpochDomain *epochDomain);
+    void initializeEpochParticipant(struct EpochParticipant *participant,
+        void **retiredBlocks, size_t maxNumberOfRetiredBlocks);
+    void addEpochParticipant(struct EpochDomain *epochDomain,
+        struct EpochParticipant *participant);
+
+    void enterEpoch(struct EpochDomain *epochDomain, struct EpochParticipant *participant);
+    void leaveEpoch(struct EpochParticipant *participant);
+    int advanceEpoch(struct EpochDomain *epochDomain);
+
+    int retireBlock(struct EpochDomain *epochDomain,
+        struct EpochParticipant *participant, void *pointer);
+    size_t collectRetiredBlocks(struct EpochDomain *epochDomain,
+        struct EpochParticipant *participant, void **pointers, size_t maxNumberOfBlocks);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
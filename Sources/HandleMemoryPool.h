@@ -0,0 +1,165 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef HandleMemoryPoolH
+#define HandleMemoryPoolH
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Inline.h"
+#include "IndexedMemoryPool.h"
+
+/* Blocks are referred by 32-bit handles made of block index in lower bits and
+   generation of the block in upper bits. Generation is incremented whenever
+   the block is released, so handles of released blocks are detected as stale
+   until the generation wraps around. */
+#ifndef HANDLE_MEMORY_POOL_INDEX_BITS
+    #define HANDLE_MEMORY_POOL_INDEX_BITS 20
+#endif
+
+#if HANDLE_MEMORY_POOL_INDEX_BITS < 16 || HANDLE_MEMORY_POOL_INDEX_BITS > 31
+    #error HANDLE_MEMORY_POOL_INDEX_BITS must be between 16 and 31
+#endif
+
+#define HANDLE_MEMORY_POOL_INDEX_MASK ((((uint32_t) 1) << HANDLE_MEMORY_POOL_INDEX_BITS) - 1)
+#define HANDLE_MEMORY_POOL_GENERATION_MASK ((uint16_t) (0xFFFFFFFFu >> HANDLE_MEMORY_POOL_INDEX_BITS))
+#define HANDLE_MEMORY_POOL_NULL_HANDLE ((uint32_t) 0xFFFFFFFFu)
+
+/* Highest index is reserved, so no valid handle is equal to the null handle */
+#define MAX_HANDLE_MEMORY_POOL_BLOCKS ((size_t) HANDLE_MEMORY_POOL_INDEX_MASK)
+
+/* Generations of blocks are kept in the same memory region, just after blocks,
+   so the whole memory region can be copied to other address. */
+struct HandleMemoryPool
+{
+    struct IndexedMemoryPool indexedMemoryPool;
+    uint16_t *generations;
+    size_t numberOfBlocks;
+};
+
+INLINE size_t inlinedGetHandleMemoryRegionSize(size_t numberOfBlocks, size_t blockSize)
+{
+    struct IndexedMemoryPool memoryPool;
+    inlinedInitializeIndexedMemoryPool(&memoryPool, NULL, 0, blockSize);
+
+    return numberOfBlocks * (memoryPool.blockSize + sizeof(uint16_t));
+}
+
+INLINE void inlinedInitializeHandleMemoryPool(struct HandleMemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t blockSize)
+{
+    size_t i;
+
+    if(!memoryRegion)
+        numberOfBlocks = 0;
+    if(numberOfBlocks > MAX_HANDLE_MEMORY_POOL_BLOCKS)
+        numberOfBlocks = MAX_HANDLE_MEMORY_POOL_BLOCKS;
+
+    inlinedInitializeIndexedMemoryPool(&memoryPool->indexedMemoryPool,
+        memoryRegion, numberOfBlocks, blockSize);
+
+    memoryPool->numberOfBlocks = numberOfBlocks;
+    memoryPool->generations = (uint16_t *) ((uint8_t *) memoryRegion +
+        numberOfBlocks * memoryPool->indexedMemoryPool.blockSize);
+
+    for(i = 0; i < numberOfBlocks; i++)
+        memoryPool->generations[i] = 0;
+}
+
+/* Memory region must be a copy of the one currently used by the memory pool.
+   Handles remain valid, while pointers to blocks do not. */
+INLINE void inlinedRelocateHandleMemoryPool(struct HandleMemoryPool *memoryPool,
+    void *memoryRegion)
+{
+    memoryPool->indexedMemoryPool.memoryRegion = (uint8_t *) memoryRegion;
+    memoryPool->generations = (uint16_t *) ((uint8_t *) memoryRegion +
+        memoryPool->numberOfBlocks * memoryPool->indexedMemoryPool.blockSize);
+}
+
+/* Returns handle of allocated block or HANDLE_MEMORY_POOL_NULL_HANDLE when none is available */
+INLINE uint32_t inlinedAllocateHandleBlock(struct HandleMemoryPool *memoryPool)
+{
+    uint32_t index = inlinedAllocateIndexedBlockIndex(&memoryPool->indexedMemoryPool);
+
+    if(index == INDEXED_MEMORY_POOL_NULL_INDEX)
+        return HANDLE_MEMORY_POOL_NULL_HANDLE;
+
+    return ((uint32_t) memoryPool->generations[index] << HANDLE_MEMORY_POOL_INDEX_BITS) | index;
+}
+
+/* Returns pointer to the block or NULL when the handle is stale */
+INLINE void *inlinedResolveHandle(const struct HandleMemoryPool *memoryPool, uint32_t handle)
+{
+    uint32_t index = handle & HANDLE_MEMORY_POOL_INDEX_MASK;
+
+    /* Blocks not yet handed out have never had any valid handle */
+    if(index >= memoryPool->indexedMemoryPool.firstNotYetUsedBlock ||
+        memoryPool->generations[index] != (handle >> HANDLE_MEMORY_POOL_INDEX_BITS))
+        return NULL;
+
+    return inlinedGetIndexedBlock(&memoryPool->indexedMemoryPool, index);
+}
+
+/* Returns non-zero when the block has been released, or zero when the handle
+   is stale, e.g. because the block has been already released */
+INLINE int inlinedReleaseHandleBlock(struct HandleMemoryPool *memoryPool, uint32_t handle)
+{
+    uint32_t index = handle & HANDLE_MEMORY_POOL_INDEX_MASK;
+
+    if(!inlinedResolveHandle(memoryPool, handle))
+        return 0;
+
+    memoryPool->generations[index] = (uint16_t) ((memoryPool->generations[index] + 1) &
+        HANDLE_MEMORY_POOL_GENERATION_MASK);
+    inlinedReleaseIndexedBlockIndex(&memoryPool->indexedMemoryPool, index);
+
+    return 1;
+}
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+    size_t getHandleMemoryRegionSize(size_t numberOfBlocks, size_t blockSize);
+    void initializeHandleMemoryPool(struct HandleMemoryPool *memoryPool,
+        void *memoryRegion, size_t numberOfBlocks, size_t blockSize);
+    void relocateHandleMemoryPool(struct HandleMemoryPool *memoryPool, void *memoryRegion);
+
+    uint32_t allocateHandleBlock(struct HandleMemoryPool *memoryPool);
+    void *resolveHandle(const struct HandleMemoryPool *memoryPool, uint32_t handle);
+    int releaseHandleBlock(struct HandleMemoryPool *memoryPool, uint32_t handle);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
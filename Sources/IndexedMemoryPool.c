@@ -0,0 +1,106 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "IndexedMemoryPool.h"
+
+void initializeIndexedMemoryPool(struct IndexedMemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t blockSize)
+{
+    inlinedInitializeIndexedMemoryPool(memoryPool, memoryRegion, numberOfBlocks, blockSize);
+}
+
+void *allocateIndexedBlock(struct IndexedMemoryPool *memoryPool)
+{
+    return inlinedAllocateIndexedBlock(memoryPool);
+}
+
+void releaseIndexedBlock(struct IndexedMemoryPool *memoryPool, void *pointer)
+{
+    inlinedReleaseIndexedBlock(memoryPool, pointer);
+}
+
+uint32_t allocateIndexedBlockIndex(struct IndexedMemoryPool *memoryPool)
+{
+    return inlinedAllocateIndexedBlockIndex(memoryPool);
+}
+
+void releaseIndexedBlockIndex(struct IndexedMemoryPool *memoryPool, uint32_t index)
+{
+    inlinedReleaseIndexedBlockIndex(memoryPool, index);
+}
+
+void *getIndexedBlock(const struct IndexedMemoryPool *memoryPool, uint32_t index)
+{
+    return inlinedGetIndexedBlock(memoryPool, index);
+}
+
+uint32_t getIndexOfIndexedBlock(const struct IndexedMemoryPool *memoryPool,
+    const void *pointer)
+{
+    return inlinedGetIndexOfIndexedBlock(memoryPool, pointer);
+}
+
+void initializeIndexedMemoryPool16(struct IndexedMemoryPool16 *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t blockSize)
+{
+    inlinedInitializeIndexedMemoryPool16(memoryPool, memoryRegion, numberOfBlocks, blockSize);
+}
+
+void *allocateIndexedBlock16(struct IndexedMemoryPool16 *memoryPool)
+{
+    return inlinedAllocateIndexedBlock16(memoryPool);
+}
+
+void releaseIndexedBlock16(struct IndexedMemoryPool16 *memoryPool, void *pointer)
+{
+    inlinedReleaseIndexedBlock16(memoryPool, pointer);
+}
+
+uint16_t allocateIndexedBlockIndex16(struct IndexedMemoryPool16 *memoryPool)
+{
+    return inlinedAllocateIndexedBlockIndex16(memoryPool);
+}
+
+void releaseIndexedBlockIndex16(struct IndexedMemoryPool16 *memoryPool, uint16_t index)
+{
+    inlinedReleaseIndexedBlockIndex16(memoryPool, index);
+}
+
+void *getIndexedBlock16(const struct IndexedMemoryPool16 *memoryPool, uint16_t index)
+{
+    return inlinedGetIndexedBlock16(memoryPool, index);
+}
+
+uint16_t getIndexOfIndexedBlock16(const struct IndexedMemoryPool16 *memoryPool,
+    const void *pointer)
+{
+    return inlinedGetIndexOfIndexedBlock16(memoryPool, pointer);
+}
@@ -0,0 +1,242 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef IndexedMemoryPoolH
+#define IndexedMemoryPoolH
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Inline.h"
+
+/* Free blocks are linked by 32-bit or 16-bit indices relative to the beginning
+   of memory region instead of pointers, so blocks can be as small as the index.
+   Block size is rounded up to a multiple of the index size and the memory
+   region must be aligned to it. */
+#define MIN_INDEXED_MEMORY_POOL_BLOCK_SIZE sizeof(uint32_t)
+#define MIN_INDEXED_MEMORY_POOL16_BLOCK_SIZE sizeof(uint16_t)
+
+#define INDEXED_MEMORY_POOL_NULL_INDEX ((uint32_t) 0xFFFFFFFFu)
+#define INDEXED_MEMORY_POOL16_NULL_INDEX ((uint16_t) 0xFFFFu)
+
+struct IndexedMemoryPool
+{
+    size_t blockSize;
+    uint8_t *memoryRegion;
+    uint32_t numberOfNotYetUsedBlocks;
+    uint32_t firstNotYetUsedBlock;
+    uint32_t firstFreeBlock;
+};
+
+INLINE void inlinedInitializeIndexedMemoryPool(struct IndexedMemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t blockSize)
+{
+    /* Last index is reserved for INDEXED_MEMORY_POOL_NULL_INDEX */
+    if(numberOfBlocks > INDEXED_MEMORY_POOL_NULL_INDEX)
+        numberOfBlocks = INDEXED_MEMORY_POOL_NULL_INDEX;
+
+    memoryPool->blockSize = (blockSize + MIN_INDEXED_MEMORY_POOL_BLOCK_SIZE - 1) & ~(MIN_INDEXED_MEMORY_POOL_BLOCK_SIZE - 1);
+    if(!memoryPool->blockSize)
+        memoryPool->blockSize = MIN_INDEXED_MEMORY_POOL_BLOCK_SIZE;
+
+    memoryPool->memoryRegion = (uint8_t *) memoryRegion;
+    memoryPool->numberOfNotYetUsedBlocks = memoryRegion ? (uint32_t) numberOfBlocks : 0;
+    memoryPool->firstNotYetUsedBlock = 0;
+    memoryPool->firstFreeBlock = INDEXED_MEMORY_POOL_NULL_INDEX;
+}
+
+INLINE void *inlinedGetIndexedBlock(const struct IndexedMemoryPool *memoryPool, uint32_t index)
+{
+    return memoryPool->memoryRegion + (size_t) index * memoryPool->blockSize;
+}
+
+INLINE uint32_t inlinedGetIndexOfIndexedBlock(const struct IndexedMemoryPool *memoryPool,
+    const void *pointer)
+{
+    return (uint32_t) ((size_t) ((const uint8_t *) pointer - memoryPool->memoryRegion) /
+        memoryPool->blockSize);
+}
+
+/* Returns index of allocated block or INDEXED_MEMORY_POOL_NULL_INDEX when none is available */
+INLINE uint32_t inlinedAllocateIndexedBlockIndex(struct IndexedMemoryPool *memoryPool)
+{
+    uint32_t index;
+
+    index = memoryPool->firstFreeBlock;
+    if(index != INDEXED_MEMORY_POOL_NULL_INDEX) {
+        memoryPool->firstFreeBlock = *(uint32_t *) inlinedGetIndexedBlock(memoryPool, index);
+        return index;
+    }
+
+    if(memoryPool->numberOfNotYetUsedBlocks) {
+        index = memoryPool->firstNotYetUsedBlock++;
+        memoryPool->numberOfNotYetUsedBlocks--;
+    }
+
+    return index;
+}
+
+INLINE void inlinedReleaseIndexedBlockIndex(struct IndexedMemoryPool *memoryPool, uint32_t index)
+{
+    *(uint32_t *) inlinedGetIndexedBlock(memoryPool, index) = memoryPool->firstFreeBlock;
+    memoryPool->firstFreeBlock = index;
+}
+
+INLINE void *inlinedAllocateIndexedBlock(struct IndexedMemoryPool *memoryPool)
+{
+    uint32_t index = inlinedAllocateIndexedBlockIndex(memoryPool);
+
+    if(index == INDEXED_MEMORY_POOL_NULL_INDEX)
+        return NULL;
+
+    return inlinedGetIndexedBlock(memoryPool, index);
+}
+
+INLINE void inlinedReleaseIndexedBlock(struct IndexedMemoryPool *memoryPool, void *pointer)
+{
+    inlinedReleaseIndexedBlockIndex(memoryPool,
+        inlinedGetIndexOfIndexedBlock(memoryPool, pointer));
+}
+
+struct IndexedMemoryPool16
+{
+    size_t blockSize;
+    uint8_t *memoryRegion;
+    uint16_t numberOfNotYetUsedBlocks;
+    uint16_t firstNotYetUsedBlock;
+    uint16_t firstFreeBlock;
+};
+
+INLINE void inlinedInitializeIndexedMemoryPool16(struct IndexedMemoryPool16 *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t blockSize)
+{
+    /* Last index is reserved for INDEXED_MEMORY_POOL16_NULL_INDEX */
+    if(numberOfBlocks > INDEXED_MEMORY_POOL16_NULL_INDEX)
+        numberOfBlocks = INDEXED_MEMORY_POOL16_NULL_INDEX;
+
+    memoryPool->blockSize = (blockSize + MIN_INDEXED_MEMORY_POOL16_BLOCK_SIZE - 1) & ~(MIN_INDEXED_MEMORY_POOL16_BLOCK_SIZE - 1);
+    if(!memoryPool->blockSize)
+        memoryPool->blockSize = MIN_INDEXED_MEMORY_POOL16_BLOCK_SIZE;
+
+    memoryPool->memoryRegion = (uint8_t *) memoryRegion;
+    memoryPool->numberOfNotYetUsedBlocks = memoryRegion ? (uint16_t) numberOfBlocks : 0;
+    memoryPool->firstNotYetUsedBlock = 0;
+    memoryPool->firstFreeBlock = INDEXED_MEMORY_POOL16_NULL_INDEX;
+}
+
+INLINE void *inlinedGetIndexedBlock16(const struct IndexedMemoryPool16 *memoryPool, uint16_t index)
+{
+    return memoryPool->memoryRegion + (size_t) index * memoryPool->blockSize;
+}
+
+INLINE uint16_t inlinedGetIndexOfIndexedBlock16(const struct IndexedMemoryPool16 *memoryPool,
+    const void *pointer)
+{
+    return (uint16_t) ((size_t) ((const uint8_t *) pointer - memoryPool->memoryRegion) /
+        memoryPool->blockSize);
+}
+
+/* Returns index of allocated block or INDEXED_MEMORY_POOL16_NULL_INDEX when none is available */
+INLINE uint16_t inlinedAllocateIndexedBlockIndex16(struct IndexedMemoryPool16 *memoryPool)
+{
+    uint16_t index;
+
+    index = memoryPool->firstFreeBlock;
+    if(index != INDEXED_MEMORY_POOL16_NULL_INDEX) {
+        memoryPool->firstFreeBlock = *(uint16_t *) inlinedGetIndexedBlock16(memoryPool, index);
+        return index;
+    }
+
+    if(memoryPool->numberOfNotYetUsedBlocks) {
+        index = memoryPool->firstNotYetUsedBlock++;
+        memoryPool->numberOfNotYetUsedBlocks--;
+    }
+
+    return index;
+}
+
+INLINE void inlinedReleaseIndexedBlockIndex16(struct IndexedMemoryPool16 *memoryPool, uint16_t index)
+{
+    *(uint16_t *) inlinedGetIndexedBlock16(memoryPool, index) = memoryPool->firstFreeBlock;
+    memoryPool->firstFreeBlock = index;
+}
+
+INLINE void *inlinedAllocateIndexedBlock16(struct IndexedMemoryPool16 *memoryPool)
+{
+    uint16_t index = inlinedAllocateIndexedBlockIndex16(memoryPool);
+
+    if(index == INDEXED_MEMORY_POOL16_NULL_INDEX)
+        return NULL;
+
+    return inlinedGetIndexedBlock16(memoryPool, index);
+}
+
+INLINE void inlinedReleaseIndexedBlock16(struct IndexedMemoryPool16 *memoryPool, void *pointer)
+{
+    inlinedReleaseIndexedBlockIndex16(memoryPool,
+        inlinedGetIndexOfIndexedBlock16(memoryPool, pointer));
+}
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+    void initializeIndexedMemoryPool(struct IndexedMemoryPool *memoryPool,
+        void *memoryRegion, size_t numberOfBlocks, size_t blockSize);
+
+    void *allocateIndexedBlock(struct IndexedMemoryPool *memoryPool);
+    void releaseIndexedBlock(struct IndexedMemoryPool *memoryPool, void *pointer);
+
+    uint32_t allocateIndexedBlockIndex(struct IndexedMemoryPool *memoryPool);
+    void releaseIndexedBlockIndex(struct IndexedMemoryPool *memoryPool, uint32_t index);
+
+    void *getIndexedBlock(const struct IndexedMemoryPool *memoryPool, uint32_t index);
+    uint32_t getIndexOfIndexedBlock(const struct IndexedMemoryPool *memoryPool,
+        const void *pointer);
+
+    void initializeIndexedMemoryPool16(struct IndexedMemoryPool16 *memoryPool,
+        void *memoryRegion, size_t numberOfBlocks, size_t blockSize);
+
+    void *allocateIndexedBlock16(struct IndexedMemoryPool16 *memoryPool);
+    void releaseIndexedBlock16(struct IndexedMemoryPool16 *memoryPool, void *pointer);
+
+    uint16_t allocateIndexedBlockIndex16(struct IndexedMemoryPool16 *memoryPool);
+    void releaseIndexedBlockIndex16(struct IndexedMemoryPool16 *memoryPool, uint16_t index);
+
+    void *getIndexedBlock16(const struct IndexedMemoryPool16 *memoryPool, uint16_t index);
+    uint16_t getIndexOfIndexedBlock16(const struct IndexedMemoryPool16 *memoryPool,
+        const void *pointer);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
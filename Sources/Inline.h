@@ -8,6 +8,8 @@
     #else
       #define INLINE inline
     #endif
+  #elif defined(__GNUC__)
+    #define INLINE static __attribute__((unused))
   #else
     #define INLINE static
   #endif
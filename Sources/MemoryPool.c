@@ -37,6 +37,41 @@ void initializeMemoryPool(struct MemoryPool *memoryPool,
     inlinedInitializeMemoryPool(memoryPool, memoryRegion, numberOfBlocks, blockSize);
 }
 
+void initializeAlignedMemoryPool(struct MemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t blockSize, size_t alignment)
+{
+    inlinedInitializeAlignedMemoryPool(memoryPool, memoryRegion, numberOfBlocks, blockSize, alignment);
+}
+
+int extendMemoryPool(struct MemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks)
+{
+    return inlinedExtendMemoryPool(memoryPool, memoryRegion, numberOfBlocks);
+}
+
+int extendAlignedMemoryPool(struct MemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t alignment)
+{
+    return inlinedExtendAlignedMemoryPool(memoryPool, memoryRegion, numberOfBlocks, alignment);
+}
+
+size_t getAlignedBlockSize(size_t blockSize, size_t alignment)
+{
+    return inlinedGetAlignedBlockSize(blockSize, alignment);
+}
+
+size_t getAlignedMemoryRegionSize(size_t numberOfBlocks,
+    size_t blockSize, size_t alignment)
+{
+    return inlinedGetAlignedMemoryRegionSize(numberOfBlocks, blockSize, alignment);
+}
+
+size_t getNumberOfAlignedBlocks(size_t memoryRegionSize,
+    size_t blockSize, size_t alignment)
+{
+    return inlinedGetNumberOfAlignedBlocks(memoryRegionSize, blockSize, alignment);
+}
+
 void *allocateBlock(struct MemoryPool *memoryPool)
 {
     return inlinedAllocateBlock(memoryPool);
@@ -46,3 +81,46 @@ void releaseBlock(struct MemoryPool *memoryPool, void *pointer)
 {
     inlinedReleaseBlock(memoryPool, pointer);
 }
+
+size_t allocateBlocks(struct MemoryPool *memoryPool,
+    void **pointers, size_t numberOfBlocks)
+{
+    return inlinedAllocateBlocks(memoryPool, pointers, numberOfBlocks);
+}
+
+void releaseBlocks(struct MemoryPool *memoryPool,
+    void **pointers, size_t numberOfBlocks)
+{
+    inlinedReleaseBlocks(memoryPool, pointers, numberOfBlocks);
+}
+
+void *allocateContiguousBlocks(struct MemoryPool *memoryPool, size_t numberOfBlocks)
+{
+    return inlinedAllocateContiguousBlocks(memoryPool, numberOfBlocks);
+}
+
+void releaseNotYetUsedBlocks(struct MemoryPool *memoryPool)
+{
+    inlinedReleaseNotYetUsedBlocks(memoryPool);
+}
+
+void releaseBlockChain(struct MemoryPool *memoryPool,
+    void *firstBlock, void *lastBlock, size_t numberOfBlocks)
+{
+    inlinedReleaseBlockChain(memoryPool, firstBlock, lastBlock, numberOfBlocks);
+}
+
+int mergeMemoryPools(struct MemoryPool *destination, struct MemoryPool *source)
+{
+    return inlinedMergeMemoryPools(destination, source);
+}
+
+size_t sortFreeList(struct MemoryPool *memoryPool)
+{
+    return inlinedSortFreeList(memoryPool);
+}
+
+size_t sortFreeListPrefix(struct MemoryPool *memoryPool, size_t maxNumberOfBlocks)
+{
+    return inlinedSortFreeListPrefix(memoryPool, maxNumberOfBlocks);
+}
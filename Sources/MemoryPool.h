@@ -39,14 +39,58 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 
 #define MIN_MEMORY_POOL_BLOCK_SIZE sizeof(void *)
 
+/* Statistics are collected only when MEMORY_POOL_STATISTICS is defined. The
+   same setting must be used for all sources, as it changes the MemoryPool
+   structure. */
+#ifdef MEMORY_POOL_STATISTICS
+struct MemoryPoolStatistics
+{
+    size_t numberOfAllocations;
+    size_t numberOfFailedAllocations;
+    size_t numberOfReleases;
+    size_t numberOfLiveBlocks;
+    size_t maxNumberOfLiveBlocks;
+    size_t numberOfMemoryRegions;
+};
+#endif
+
+/* Last elements of the list of free blocks and of the list of pending runs
+   are valid only while the lists are not empty. */
 struct MemoryPool
 {
     size_t blockSize;
     size_t numberOfNotYetUsedBlocks;
     void *notYetUsedBlocks;
     void *firstFreeBlock;
+    void *lastFreeBlock;
+    void *firstPendingRun;
+    void *lastPendingRun;
+#ifdef MEMORY_POOL_STATISTICS
+    struct MemoryPoolStatistics statistics;
+#endif
 };
 
+#ifdef MEMORY_POOL_STATISTICS
+INLINE void inlinedCountAllocatedBlocks(struct MemoryPool *memoryPool,
+    size_t numberOfAllocatedBlocks, size_t numberOfRequestedBlocks)
+{
+    struct MemoryPoolStatistics *statistics = &memoryPool->statistics;
+
+    statistics->numberOfAllocations += numberOfAllocatedBlocks;
+    statistics->numberOfFailedAllocations += numberOfRequestedBlocks - numberOfAllocatedBlocks;
+    statistics->numberOfLiveBlocks += numberOfAllocatedBlocks;
+
+    if(statistics->numberOfLiveBlocks > statistics->maxNumberOfLiveBlocks)
+        statistics->maxNumberOfLiveBlocks = statistics->numberOfLiveBlocks;
+}
+
+INLINE void inlinedCountReleasedBlocks(struct MemoryPool *memoryPool, size_t numberOfBlocks)
+{
+    memoryPool->statistics.numberOfReleases += numberOfBlocks;
+    memoryPool->statistics.numberOfLiveBlocks -= numberOfBlocks;
+}
+#endif
+
 INLINE void inlinedInitializeMemoryPool(struct MemoryPool *memoryPool,
     void *memoryRegion, size_t numberOfBlocks, size_t blockSize)
 {
@@ -57,6 +101,130 @@ INLINE void inlinedInitializeMemoryPool(struct MemoryPool *memoryPool,
     memoryPool->numberOfNotYetUsedBlocks = numberOfBlocks;
     memoryPool->notYetUsedBlocks = memoryRegion;
     memoryPool->firstFreeBlock = NULL;
+    memoryPool->lastFreeBlock = NULL;
+    memoryPool->firstPendingRun = NULL;
+    memoryPool->lastPendingRun = NULL;
+
+#ifdef MEMORY_POOL_STATISTICS
+    memoryPool->statistics.numberOfAllocations = 0;
+    memoryPool->statistics.numberOfFailedAllocations = 0;
+    memoryPool->statistics.numberOfReleases = 0;
+    memoryPool->statistics.numberOfLiveBlocks = 0;
+    memoryPool->statistics.maxNumberOfLiveBlocks = 0;
+    memoryPool->statistics.numberOfMemoryRegions = memoryRegion ? 1 : 0;
+#endif
+}
+
+/* Alignment must be a power of two. Values 0 and 1 mean no alignment. */
+INLINE size_t inlinedGetAlignedBlockSize(size_t blockSize, size_t alignment)
+{
+    if(blockSize < MIN_MEMORY_POOL_BLOCK_SIZE)
+        blockSize = MIN_MEMORY_POOL_BLOCK_SIZE;
+
+    if(alignment > 1)
+        blockSize = (blockSize + alignment - 1) & ~(alignment - 1);
+
+    return blockSize;
+}
+
+INLINE size_t inlinedGetAlignedMemoryRegionSize(size_t numberOfBlocks,
+    size_t blockSize, size_t alignment)
+{
+    size_t memoryRegionSize = numberOfBlocks * inlinedGetAlignedBlockSize(blockSize, alignment);
+
+    if(alignment > 1)
+        memoryRegionSize += alignment - 1;
+
+    return memoryRegionSize;
+}
+
+INLINE size_t inlinedGetNumberOfAlignedBlocks(size_t memoryRegionSize,
+    size_t blockSize, size_t alignment)
+{
+    if(alignment > 1) {
+        if(memoryRegionSize < alignment - 1)
+            return 0;
+        memoryRegionSize -= alignment - 1;
+    }
+
+    return memoryRegionSize / inlinedGetAlignedBlockSize(blockSize, alignment);
+}
+
+INLINE void inlinedInitializeAlignedMemoryPool(struct MemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t blockSize, size_t alignment)
+{
+    if(alignment > 1 && memoryRegion) {
+        memoryRegion = (void *) (((uintptr_t) memoryRegion + alignment - 1) &
+            ~((uintptr_t) alignment - 1));
+    }
+
+    inlinedInitializeMemoryPool(memoryPool, memoryRegion, numberOfBlocks,
+        inlinedGetAlignedBlockSize(blockSize, alignment));
+}
+
+/* Gives the memory pool another memory region, once all blocks of the
+   previous one are used. Unlike initialization, the list of free blocks and
+   pending runs are kept. Returns 0 when the memory pool still has not yet used
+   blocks. */
+INLINE int inlinedExtendMemoryPool(struct MemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks)
+{
+    if(memoryPool->numberOfNotYetUsedBlocks)
+        return 0;
+
+    memoryPool->numberOfNotYetUsedBlocks = numberOfBlocks;
+    memoryPool->notYetUsedBlocks = memoryRegion;
+
+#ifdef MEMORY_POOL_STATISTICS
+    memoryPool->statistics.numberOfMemoryRegions++;
+#endif
+
+    return 1;
+}
+
+INLINE int inlinedExtendAlignedMemoryPool(struct MemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t alignment)
+{
+    if(alignment > 1 && memoryRegion) {
+        memoryRegion = (void *) (((uintptr_t) memoryRegion + alignment - 1) &
+            ~((uintptr_t) alignment - 1));
+    }
+
+    return inlinedExtendMemoryPool(memoryPool, memoryRegion, numberOfBlocks);
+}
+
+/* Runs of not yet used blocks taken over by merging wait on the list of
+   pending runs until the current run is used up. A pending run has at least
+   two blocks: the first one links the next run and the second one holds the
+   number of blocks of the run. */
+INLINE void inlinedPushPendingRun(struct MemoryPool *memoryPool,
+    void *run, size_t numberOfBlocks)
+{
+    *(void **) run = NULL;
+    *(size_t *) ((uint8_t *) run + memoryPool->blockSize) = numberOfBlocks;
+
+    if(memoryPool->firstPendingRun)
+        *(void **) memoryPool->lastPendingRun = run;
+    else
+        memoryPool->firstPendingRun = run;
+
+    memoryPool->lastPendingRun = run;
+}
+
+/* Makes the first pending run the current one. Must be called only when the
+   current run is used up. Returns 0 when there are no pending runs. */
+INLINE int inlinedTakePendingRun(struct MemoryPool *memoryPool)
+{
+    void *run = memoryPool->firstPendingRun;
+
+    if(!run)
+        return 0;
+
+    memoryPool->firstPendingRun = *(void **) run;
+    memoryPool->notYetUsedBlocks = run;
+    memoryPool->numberOfNotYetUsedBlocks = *(size_t *) ((uint8_t *) run + memoryPool->blockSize);
+
+    return 1;
 }
 
 INLINE void *inlinedAllocateBlock(struct MemoryPool *memoryPool)
@@ -66,24 +234,338 @@ INLINE void *inlinedAllocateBlock(struct MemoryPool *memoryPool)
     pointer = memoryPool->firstFreeBlock;
     if(pointer) {
         memoryPool->firstFreeBlock = *(void **) pointer;
-        return pointer;
-    }
-
-    if(memoryPool->numberOfNotYetUsedBlocks) {
+    } else if(memoryPool->numberOfNotYetUsedBlocks || inlinedTakePendingRun(memoryPool)) {
         pointer = memoryPool->notYetUsedBlocks;
         memoryPool->notYetUsedBlocks = ((uint8_t *) pointer) + memoryPool->blockSize;
         memoryPool->numberOfNotYetUsedBlocks--;
     }
 
+#ifdef MEMORY_POOL_STATISTICS
+    inlinedCountAllocatedBlocks(memoryPool, pointer ? 1 : 0, 1);
+#endif
+
     return pointer;
 }
 
 INLINE void inlinedReleaseBlock(struct MemoryPool *memoryPool, void *pointer)
 {
+#ifdef MEMORY_POOL_STATISTICS
+    inlinedCountReleasedBlocks(memoryPool, 1);
+#endif
+
+    if(!memoryPool->firstFreeBlock)
+        memoryPool->lastFreeBlock = pointer;
+
     *(void **) pointer = memoryPool->firstFreeBlock;
     memoryPool->firstFreeBlock = pointer;
 }
 
+INLINE size_t inlinedAllocateBlocks(struct MemoryPool *memoryPool,
+    void **pointers, size_t numberOfBlocks)
+{
+    size_t numberOfAllocatedBlocks;
+    size_t numberOfCarvedBlocks;
+    uint8_t *pointer;
+
+    pointer = (uint8_t *) memoryPool->firstFreeBlock;
+    for(numberOfAllocatedBlocks = 0; pointer && numberOfAllocatedBlocks < numberOfBlocks;
+        numberOfAllocatedBlocks++) {
+        pointers[numberOfAllocatedBlocks] = pointer;
+        pointer = (uint8_t *) *(void **) pointer;
+    }
+
+    memoryPool->firstFreeBlock = pointer;
+
+    while(numberOfAllocatedBlocks < numberOfBlocks &&
+        (memoryPool->numberOfNotYetUsedBlocks || inlinedTakePendingRun(memoryPool))) {
+        numberOfCarvedBlocks = numberOfBlocks - numberOfAllocatedBlocks;
+        if(numberOfCarvedBlocks > memoryPool->numberOfNotYetUsedBlocks)
+            numberOfCarvedBlocks = memoryPool->numberOfNotYetUsedBlocks;
+
+        pointer = (uint8_t *) memoryPool->notYetUsedBlocks;
+        memoryPool->notYetUsedBlocks = pointer + numberOfCarvedBlocks * memoryPool->blockSize;
+        memoryPool->numberOfNotYetUsedBlocks -= numberOfCarvedBlocks;
+
+        for(; numberOfCarvedBlocks; numberOfCarvedBlocks--) {
+            pointers[numberOfAllocatedBlocks++] = pointer;
+            pointer += memoryPool->blockSize;
+        }
+    }
+
+#ifdef MEMORY_POOL_STATISTICS
+    inlinedCountAllocatedBlocks(memoryPool, numberOfAllocatedBlocks, numberOfBlocks);
+#endif
+
+    return numberOfAllocatedBlocks;
+}
+
+/* Allocates adjacent blocks, which are taken from the current run of not yet
+   used blocks only. Returns NULL when there are not enough of them. */
+INLINE void *inlinedAllocateContiguousBlocks(struct MemoryPool *memoryPool, size_t numberOfBlocks)
+{
+    void *pointer;
+
+    if(!memoryPool->numberOfNotYetUsedBlocks)
+        inlinedTakePendingRun(memoryPool);
+
+    if(!numberOfBlocks || numberOfBlocks > memoryPool->numberOfNotYetUsedBlocks) {
+#ifdef MEMORY_POOL_STATISTICS
+        inlinedCountAllocatedBlocks(memoryPool, 0, numberOfBlocks);
+#endif
+        return NULL;
+    }
+
+    pointer = memoryPool->notYetUsedBlocks;
+    memoryPool->notYetUsedBlocks = (uint8_t *) pointer + numberOfBlocks * memoryPool->blockSize;
+    memoryPool->numberOfNotYetUsedBlocks -= numberOfBlocks;
+
+#ifdef MEMORY_POOL_STATISTICS
+    inlinedCountAllocatedBlocks(memoryPool, numberOfBlocks, numberOfBlocks);
+#endif
+
+    return pointer;
+}
+
+INLINE void inlinedReleaseBlocks(struct MemoryPool *memoryPool,
+    void **pointers, size_t numberOfBlocks)
+{
+    size_t i;
+
+    if(!numberOfBlocks)
+        return;
+
+#ifdef MEMORY_POOL_STATISTICS
+    inlinedCountReleasedBlocks(memoryPool, numberOfBlocks);
+#endif
+
+    for(i = 1; i < numberOfBlocks; i++)
+        *(void **) pointers[i - 1] = pointers[i];
+
+    if(!memoryPool->firstFreeBlock)
+        memoryPool->lastFreeBlock = pointers[numberOfBlocks - 1];
+
+    *(void **) pointers[numberOfBlocks - 1] = memoryPool->firstFreeBlock;
+    memoryPool->firstFreeBlock = pointers[0];
+}
+
+/* Blocks from firstBlock to lastBlock must be already linked together in the
+   same way as on the list of free blocks. */
+INLINE void inlinedReleaseBlockChain(struct MemoryPool *memoryPool,
+    void *firstBlock, void *lastBlock, size_t numberOfBlocks)
+{
+    if(!numberOfBlocks)
+        return;
+
+#ifdef MEMORY_POOL_STATISTICS
+    inlinedCountReleasedBlocks(memoryPool, numberOfBlocks);
+#endif
+
+    if(!memoryPool->firstFreeBlock)
+        memoryPool->lastFreeBlock = lastBlock;
+
+    *(void **) lastBlock = memoryPool->firstFreeBlock;
+    memoryPool->firstFreeBlock = firstBlock;
+}
+
+/* Links the current run of not yet used blocks into the list of free blocks,
+   e.g. before the memory pool is extended while some of them are left. */
+INLINE void inlinedReleaseNotYetUsedBlocks(struct MemoryPool *memoryPool)
+{
+    uint8_t *pointer;
+    size_t i;
+
+    if(!memoryPool->numberOfNotYetUsedBlocks)
+        return;
+
+    pointer = (uint8_t *) memoryPool->notYetUsedBlocks;
+    for(i = 1; i < memoryPool->numberOfNotYetUsedBlocks; i++) {
+        *(void **) pointer = pointer + memoryPool->blockSize;
+        pointer += memoryPool->blockSize;
+    }
+
+    if(!memoryPool->firstFreeBlock)
+        memoryPool->lastFreeBlock = pointer;
+
+    *(void **) pointer = memoryPool->firstFreeBlock;
+    memoryPool->firstFreeBlock = memoryPool->notYetUsedBlocks;
+
+    memoryPool->numberOfNotYetUsedBlocks = 0;
+    memoryPool->notYetUsedBlocks = NULL;
+}
+
+/* Moves all available blocks of source memory pool to destination memory pool
+   in constant time. The longer run of not yet used blocks stays the current
+   one, the shorter one becomes pending, and the lists of free blocks and of
+   pending runs are spliced by their last elements.
+   Statistics of source memory pool are added to destination memory pool. */
+INLINE int inlinedMergeMemoryPools(struct MemoryPool *destination, struct MemoryPool *source)
+{
+    size_t numberOfNotYetUsedBlocks;
+    void *notYetUsedBlocks;
+#ifdef MEMORY_POOL_STATISTICS
+    struct MemoryPoolStatistics statistics;
+#endif
+
+    if(destination->blockSize != source->blockSize)
+        return 0;
+
+#ifdef MEMORY_POOL_STATISTICS
+    statistics = source->statistics;
+#endif
+
+    numberOfNotYetUsedBlocks = source->numberOfNotYetUsedBlocks;
+    notYetUsedBlocks = source->notYetUsedBlocks;
+
+    if(numberOfNotYetUsedBlocks > destination->numberOfNotYetUsedBlocks) {
+        numberOfNotYetUsedBlocks = destination->numberOfNotYetUsedBlocks;
+        notYetUsedBlocks = destination->notYetUsedBlocks;
+
+        destination->numberOfNotYetUsedBlocks = source->numberOfNotYetUsedBlocks;
+        destination->notYetUsedBlocks = source->notYetUsedBlocks;
+    }
+
+    /* A single block has no room for the header of a pending run */
+    if(numberOfNotYetUsedBlocks == 1) {
+        if(!source->firstFreeBlock)
+            source->lastFreeBlock = notYetUsedBlocks;
+
+        *(void **) notYetUsedBlocks = source->firstFreeBlock;
+        source->firstFreeBlock = notYetUsedBlocks;
+    } else if(numberOfNotYetUsedBlocks) {
+        inlinedPushPendingRun(destination, notYetUsedBlocks, numberOfNotYetUsedBlocks);
+    }
+
+    if(source->firstPendingRun) {
+        if(destination->firstPendingRun)
+            *(void **) destination->lastPendingRun = source->firstPendingRun;
+        else
+            destination->firstPendingRun = source->firstPendingRun;
+
+        destination->lastPendingRun = source->lastPendingRun;
+    }
+
+    if(source->firstFreeBlock) {
+        if(destination->firstFreeBlock)
+            *(void **) source->lastFreeBlock = destination->firstFreeBlock;
+        else
+            destination->lastFreeBlock = source->lastFreeBlock;
+
+        destination->firstFreeBlock = source->firstFreeBlock;
+    }
+
+    inlinedInitializeMemoryPool(source, NULL, 0, source->blockSize);
+
+#ifdef MEMORY_POOL_STATISTICS
+    if(statistics.maxNumberOfLiveBlocks > destination->statistics.maxNumberOfLiveBlocks)
+        destination->statistics.maxNumberOfLiveBlocks = statistics.maxNumberOfLiveBlocks;
+
+    destination->statistics.numberOfAllocations += statistics.numberOfAllocations;
+    destination->statistics.numberOfFailedAllocations += statistics.numberOfFailedAllocations;
+    destination->statistics.numberOfReleases += statistics.numberOfReleases;
+    destination->statistics.numberOfLiveBlocks += statistics.numberOfLiveBlocks;
+    destination->statistics.numberOfMemoryRegions += statistics.numberOfMemoryRegions;
+#endif
+
+    return 1;
+}
+
+#define MEMORY_POOL_RADIX_BITS 8
+#define MEMORY_POOL_RADIX_SIZE (1 << MEMORY_POOL_RADIX_BITS)
+
+/* Sorts up to maxNumberOfBlocks blocks from the beginning of the list of free
+   blocks by their addresses, so that blocks allocated next are adjacent in
+   memory. Blocks are sorted by LSD radix sort of their offsets from the lowest
+   address, skipping bits equal for all blocks. Returns number of sorted blocks. */
+INLINE size_t inlinedSortFreeListPrefix(struct MemoryPool *memoryPool, size_t maxNumberOfBlocks)
+{
+    void *heads[MEMORY_POOL_RADIX_SIZE];
+    void *tails[MEMORY_POOL_RADIX_SIZE];
+    void *firstBlock;
+    void *lastBlock;
+    void *remainingBlocks;
+    void *block;
+    uintptr_t lowestAddress;
+    uintptr_t keyBits;
+    uintptr_t remainingKeyBits;
+    size_t numberOfBlocks;
+    size_t shift;
+    size_t bucket;
+
+    firstBlock = memoryPool->firstFreeBlock;
+    if(!firstBlock || maxNumberOfBlocks < 2)
+        return 0;
+
+    lowestAddress = (uintptr_t) firstBlock;
+    lastBlock = firstBlock;
+    numberOfBlocks = 0;
+
+    for(block = firstBlock; block && numberOfBlocks < maxNumberOfBlocks; block = *(void **) block) {
+        if((uintptr_t) block < lowestAddress)
+            lowestAddress = (uintptr_t) block;
+
+        lastBlock = block;
+        numberOfBlocks++;
+    }
+
+    remainingBlocks = block;
+    *(void **) lastBlock = NULL;
+
+    keyBits = 0;
+    for(block = firstBlock; block; block = *(void **) block)
+        keyBits |= (uintptr_t) block - lowestAddress;
+
+    shift = 0;
+    if(keyBits) {
+        while(!((keyBits >> shift) & 1))
+            shift++;
+    }
+
+    for(remainingKeyBits = keyBits >> shift; remainingKeyBits;
+        remainingKeyBits >>= MEMORY_POOL_RADIX_BITS, shift += MEMORY_POOL_RADIX_BITS) {
+        for(bucket = 0; bucket < MEMORY_POOL_RADIX_SIZE; bucket++)
+            heads[bucket] = NULL;
+
+        for(block = firstBlock; block; block = *(void **) block) {
+            bucket = (((uintptr_t) block - lowestAddress) >> shift) & (MEMORY_POOL_RADIX_SIZE - 1);
+
+            if(heads[bucket])
+                *(void **) tails[bucket] = block;
+            else
+                heads[bucket] = block;
+
+            tails[bucket] = block;
+        }
+
+        firstBlock = NULL;
+        for(bucket = 0; bucket < MEMORY_POOL_RADIX_SIZE; bucket++) {
+            if(!heads[bucket])
+                continue;
+
+            if(firstBlock)
+                *(void **) lastBlock = heads[bucket];
+            else
+                firstBlock = heads[bucket];
+
+            lastBlock = tails[bucket];
+        }
+
+        *(void **) lastBlock = NULL;
+    }
+
+    *(void **) lastBlock = remainingBlocks;
+    memoryPool->firstFreeBlock = firstBlock;
+
+    if(!remainingBlocks)
+        memoryPool->lastFreeBlock = lastBlock;
+
+    return numberOfBlocks;
+}
+
+INLINE size_t inlinedSortFreeList(struct MemoryPool *memoryPool)
+{
+    return inlinedSortFreeListPrefix(memoryPool, (size_t) -1);
+}
+
 #ifdef __cplusplus
     extern "C" {
 #endif
@@ -91,9 +573,38 @@ INLINE void inlinedReleaseBlock(struct MemoryPool *memoryPool, void *pointer)
     void initializeMemoryPool(struct MemoryPool *memoryPool,
         void *memoryRegion, size_t numberOfBlocks, size_t blockSize);
 
+    void initializeAlignedMemoryPool(struct MemoryPool *memoryPool,
+        void *memoryRegion, size_t numberOfBlocks, size_t blockSize, size_t alignment);
+
+    int extendMemoryPool(struct MemoryPool *memoryPool,
+        void *memoryRegion, size_t numberOfBlocks);
+    int extendAlignedMemoryPool(struct MemoryPool *memoryPool,
+        void *memoryRegion, size_t numberOfBlocks, size_t alignment);
+
+    size_t getAlignedBlockSize(size_t blockSize, size_t alignment);
+    size_t getAlignedMemoryRegionSize(size_t numberOfBlocks,
+        size_t blockSize, size_t alignment);
+    size_t getNumberOfAlignedBlocks(size_t memoryRegionSize,
+        size_t blockSize, size_t alignment);
+
     void *allocateBlock(struct MemoryPool *memoryPool);
     void releaseBlock(struct MemoryPool *memoryPool, void *pointer);
 
+    size_t allocateBlocks(struct MemoryPool *memoryPool,
+        void **pointers, size_t numberOfBlocks);
+    void releaseBlocks(struct MemoryPool *memoryPool,
+        void **pointers, size_t numberOfBlocks);
+
+    void *allocateContiguousBlocks(struct MemoryPool *memoryPool, size_t numberOfBlocks);
+    void releaseNotYetUsedBlocks(struct MemoryPool *memoryPool);
+
+    void releaseBlockChain(struct MemoryPool *memoryPool,
+        void *firstBlock, void *lastBlock, size_t numberOfBlocks);
+    int mergeMemoryPools(struct MemoryPool *destination, struct MemoryPool *source);
+
+    size_t sortFreeList(struct MemoryPool *memoryPool);
+    size_t sortFreeListPrefix(struct MemoryPool *memoryPool, size_t maxNumberOfBlocks);
+
 #ifdef __cplusplus
     }
 #endif
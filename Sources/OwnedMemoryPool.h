@@ -0,0 +1,135 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef OwnedMemoryPoolH
+#define OwnedMemoryPoolH
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Inline.h"
+#include "Atomic.h"
+#include "MemoryPool.h"
+
+#define OWNED_MEMORY_POOL_CACHE_LINE_SIZE 64
+
+/* MemoryPool used by a single owner thread, to which any other thread may
+   release blocks. Such remote releases are pushed onto a lock-free stack,
+   which the owner takes over as a whole when it runs out of free blocks.
+   Blocks are allocated and released by the owner without atomic operations. */
+struct OwnedMemoryPool
+{
+    struct MemoryPool memoryPool;
+    /* Keeps the stack modified by other threads out of the owner's cache line */
+    uint8_t padding[OWNED_MEMORY_POOL_CACHE_LINE_SIZE];
+    void *volatile firstRemoteFreeBlock;
+};
+
+INLINE void inlinedInitializeOwnedMemoryPool(struct OwnedMemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks, size_t blockSize)
+{
+    inlinedInitializeMemoryPool(&memoryPool->memoryPool, memoryRegion, numberOfBlocks, blockSize);
+    memoryPool->firstRemoteFreeBlock = NULL;
+}
+
+INLINE int inlinedExtendOwnedMemoryPool(struct OwnedMemoryPool *memoryPool,
+    void *memoryRegion, size_t numberOfBlocks)
+{
+    return inlinedExtendMemoryPool(&memoryPool->memoryPool, memoryRegion, numberOfBlocks);
+}
+
+/* Moves blocks released by other threads to the list of free blocks. Returns
+   number of moved blocks. Must be called by the owner thread only. */
+INLINE size_t inlinedReclaimRemoteBlocks(struct OwnedMemoryPool *memoryPool)
+{
+    void *firstBlock;
+    void *lastBlock;
+    size_t numberOfBlocks = 1;
+
+    if(!memoryPool->firstRemoteFreeBlock)
+        return 0;
+
+    firstBlock = atomicExchangePointer(&memoryPool->firstRemoteFreeBlock, NULL);
+    for(lastBlock = firstBlock; *(void **) lastBlock; lastBlock = *(void **) lastBlock)
+        numberOfBlocks++;
+
+    inlinedReleaseBlockChain(&memoryPool->memoryPool, firstBlock, lastBlock, numberOfBlocks);
+
+    return numberOfBlocks;
+}
+
+/* Must be called by the owner thread only */
+INLINE void *inlinedAllocateOwnedBlock(struct OwnedMemoryPool *memoryPool)
+{
+    if(!memoryPool->memoryPool.firstFreeBlock && !memoryPool->memoryPool.numberOfNotYetUsedBlocks &&
+        !memoryPool->memoryPool.firstPendingRun)
+        inlinedReclaimRemoteBlocks(memoryPool);
+
+    return inlinedAllocateBlock(&memoryPool->memoryPool);
+}
+
+/* Must be called by the owner thread only */
+INLINE void inlinedReleaseOwnedBlock(struct OwnedMemoryPool *memoryPool, void *pointer)
+{
+    inlinedReleaseBlock(&memoryPool->memoryPool, pointer);
+}
+
+/* May be called by any thread. Pushing only, with the whole stack taken over
+   by the owner, is not exposed to ABA problem. */
+INLINE void inlinedReleaseRemoteBlock(struct OwnedMemoryPool *memoryPool, void *pointer)
+{
+    void *firstBlock;
+
+    do {
+        firstBlock = memoryPool->firstRemoteFreeBlock;
+        *(void *volatile *) pointer = firstBlock;
+    } while(!atomicCompareExchangePointer(&memoryPool->firstRemoteFreeBlock, firstBlock, pointer));
+}
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+    void initializeOwnedMemoryPool(struct OwnedMemoryPool *memoryPool,
+        void *memoryRegion, size_t numberOfBlocks, size_t blockSize);
+    int extendOwnedMemoryPool(struct OwnedMemoryPool *memoryPool,
+        void *memoryRegion, size_t numberOfBlocks);
+
+    size_t reclaimRemoteBlocks(struct OwnedMemoryPool *memoryPool);
+    void *allocateOwnedBlock(struct OwnedMemoryPool *memoryPool);
+    void releaseOwnedBlock(struct OwnedMemoryPool *memoryPool, void *pointer);
+    void releaseRemoteBlock(struct OwnedMemoryPool *memoryPool, void *pointer);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
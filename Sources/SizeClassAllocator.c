@@ -0,0 +1,62 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "SizeClassAllocator.h"
+
+const size_t defaultSizeClasses[] = {
+    16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256, 320, 384, 448, 512,
+    640, 768, 896, 1024
+};
+
+const size_t numberOfDefaultSizeClasses =
+    sizeof(defaultSizeClasses) / sizeof(defaultSizeClasses[0]);
+
+int initializeSizeClassAllocator(struct SizeClassAllocator *allocator,
+    struct MemoryPool *memoryPools, const size_t *blockSizes, size_t numberOfSizeClasses)
+{
+    return inlinedInitializeSizeClassAllocator(allocator, memoryPools, blockSizes, numberOfSizeClasses);
+}
+
+size_t getSizeClass(const struct SizeClassAllocator *allocator, size_t size)
+{
+    return inlinedGetSizeClass(allocator, size);
+}
+
+void *allocateSizeClassBlock(struct SizeClassAllocator *allocator, size_t size)
+{
+    return inlinedAllocateSizeClassBlock(allocator, size);
+}
+
+void releaseSizeClassBlock(struct SizeClassAllocator *allocator, void *pointer, size_t size)
+{
+    inlinedReleaseSizeClassBlock(allocator, pointer, size);
+}
@@ -0,0 +1,153 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef SizeClassAllocatorH
+#define SizeClassAllocatorH
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Inline.h"
+#include "MemoryPool.h"
+
+#ifndef SIZE_CLASS_GRANULARITY_SHIFT
+    #define SIZE_CLASS_GRANULARITY_SHIFT 4
+#endif
+
+#ifndef MAX_SIZE_CLASS_BLOCK_SIZE
+    #define MAX_SIZE_CLASS_BLOCK_SIZE 1024
+#endif
+
+#define SIZE_CLASS_GRANULARITY ((size_t) 1 << SIZE_CLASS_GRANULARITY_SHIFT)
+
+/* One entry for each multiple of granularity up to the max block size, followed
+   by an entry for all bigger sizes, which never points to valid size class. */
+#define SIZE_CLASS_LOOKUP_SIZE (MAX_SIZE_CLASS_BLOCK_SIZE / SIZE_CLASS_GRANULARITY + 2)
+
+struct SizeClassAllocator
+{
+    struct MemoryPool *memoryPools;
+    size_t numberOfSizeClasses;
+    uint8_t sizeClassLookup[SIZE_CLASS_LOOKUP_SIZE];
+};
+
+/* Block sizes must be given in ascending order and none of them may be smaller
+   than MIN_MEMORY_POOL_BLOCK_SIZE. Otherwise the allocator is left without any
+   size class, so it serves no sizes, and 0 is returned. */
+INLINE int inlinedInitializeSizeClassAllocator(struct SizeClassAllocator *allocator,
+    struct MemoryPool *memoryPools, const size_t *blockSizes, size_t numberOfSizeClasses)
+{
+    size_t sizeClass;
+    size_t slot;
+    int isValid = 1;
+
+    if(numberOfSizeClasses > UINT8_MAX)
+        numberOfSizeClasses = UINT8_MAX;
+
+    for(sizeClass = 0; sizeClass < numberOfSizeClasses; sizeClass++) {
+        if(blockSizes[sizeClass] < MIN_MEMORY_POOL_BLOCK_SIZE ||
+            (sizeClass && blockSizes[sizeClass] < blockSizes[sizeClass - 1]))
+            isValid = 0;
+    }
+
+    if(!isValid)
+        numberOfSizeClasses = 0;
+
+    allocator->memoryPools = memoryPools;
+    allocator->numberOfSizeClasses = numberOfSizeClasses;
+
+    for(sizeClass = 0; sizeClass < numberOfSizeClasses; sizeClass++)
+        inlinedInitializeMemoryPool(&memoryPools[sizeClass], NULL, 0, blockSizes[sizeClass]);
+
+    sizeClass = 0;
+    for(slot = 0; slot < SIZE_CLASS_LOOKUP_SIZE - 1; slot++) {
+        while(sizeClass < numberOfSizeClasses &&
+            blockSizes[sizeClass] < slot * SIZE_CLASS_GRANULARITY)
+            sizeClass++;
+
+        allocator->sizeClassLookup[slot] = (uint8_t) sizeClass;
+    }
+
+    allocator->sizeClassLookup[slot] = (uint8_t) numberOfSizeClasses;
+
+    return isValid;
+}
+
+/* Returns number of size classes, when size is too big for any of them. */
+INLINE size_t inlinedGetSizeClass(const struct SizeClassAllocator *allocator, size_t size)
+{
+    size_t slot;
+
+    slot = (size >> SIZE_CLASS_GRANULARITY_SHIFT) + ((size & (SIZE_CLASS_GRANULARITY - 1)) != 0);
+    slot = slot < SIZE_CLASS_LOOKUP_SIZE - 1 ? slot : SIZE_CLASS_LOOKUP_SIZE - 1;
+
+    return allocator->sizeClassLookup[slot];
+}
+
+INLINE void *inlinedAllocateSizeClassBlock(struct SizeClassAllocator *allocator, size_t size)
+{
+    size_t sizeClass = inlinedGetSizeClass(allocator, size);
+
+    if(sizeClass >= allocator->numberOfSizeClasses)
+        return NULL;
+
+    return inlinedAllocateBlock(&allocator->memoryPools[sizeClass]);
+}
+
+INLINE void inlinedReleaseSizeClassBlock(struct SizeClassAllocator *allocator,
+    void *pointer, size_t size)
+{
+    size_t sizeClass = inlinedGetSizeClass(allocator, size);
+
+    if(sizeClass < allocator->numberOfSizeClasses)
+        inlinedReleaseBlock(&allocator->memoryPools[sizeClass], pointer);
+}
+
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+    extern const size_t defaultSizeClasses[];
+    extern const size_t numberOfDefaultSizeClasses;
+
+    int initializeSizeClassAllocator(struct SizeClassAllocator *allocator,
+        struct MemoryPool *memoryPools, const size_t *blockSizes, size_t numberOfSizeClasses);
+
+    size_t getSizeClass(const struct SizeClassAllocator *allocator, size_t size);
+
+    void *allocateSizeClassBlock(struct SizeClassAllocator *allocator, size_t size);
+    void releaseSizeClassBlock(struct SizeClassAllocator *allocator, void *pointer, size_t size);
+
+#ifdef __cplusplus
+    }
+#endif
+
+#endif
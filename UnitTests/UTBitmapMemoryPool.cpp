@@ -0,0 +1,129 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "BitmapMemoryPool.h"
+#include "gtest.h"
+
+TEST(BitmapMemoryPool, EmptyMemoryRegion)
+{
+    BitmapMemoryPool memoryPool;
+    initializeBitmapMemoryPool(&memoryPool, NULL, 0, 1);
+
+    EXPECT_TRUE(allocateBitmapBlock(&memoryPool) == NULL);
+}
+
+TEST(BitmapMemoryPool, RegionSize)
+{
+    EXPECT_EQ(0u, getBitmapMemoryRegionSize(0, 1));
+    EXPECT_EQ(sizeof(size_t) + 1u, getBitmapMemoryRegionSize(1, 1));
+    EXPECT_EQ(sizeof(size_t) + BITMAP_WORD_BITS * 2u, getBitmapMemoryRegionSize(BITMAP_WORD_BITS, 2));
+    EXPECT_EQ(2u * sizeof(size_t) + BITMAP_WORD_BITS + 1u, getBitmapMemoryRegionSize(BITMAP_WORD_BITS + 1, 1));
+}
+
+TEST(BitmapMemoryPool, SingleByteBlocks)
+{
+    const size_t numberOfBlocks = 100;
+    size_t memoryRegion[(numberOfBlocks + 2 * sizeof(size_t) * 8) / sizeof(size_t)];
+    ASSERT_LE(getBitmapMemoryRegionSize(numberOfBlocks, 1), sizeof(memoryRegion));
+
+    BitmapMemoryPool memoryPool;
+    initializeBitmapMemoryPool(&memoryPool, memoryRegion, numberOfBlocks, 1);
+
+    uint8_t *first = (uint8_t *) allocateBitmapBlock(&memoryPool);
+    ASSERT_TRUE(first != NULL);
+
+    for(size_t i = 1; i < numberOfBlocks; i++) {
+        uint8_t *pointer = (uint8_t *) allocateBitmapBlock(&memoryPool);
+        EXPECT_TRUE(pointer == first + i);
+    }
+
+    EXPECT_TRUE(allocateBitmapBlock(&memoryPool) == NULL);
+}
+
+TEST(BitmapMemoryPool, LowestAddressFirst)
+{
+    const size_t numberOfBlocks = 3 * BITMAP_WORD_BITS;
+    size_t memoryRegion[3 + numberOfBlocks * 2 / sizeof(size_t)];
+
+    BitmapMemoryPool memoryPool;
+    initializeBitmapMemoryPool(&memoryPool, memoryRegion, numberOfBlocks, 2);
+
+    uint16_t *blocks[numberOfBlocks];
+    for(size_t i = 0; i < numberOfBlocks; i++)
+        blocks[i] = (uint16_t *) allocateBitmapBlock(&memoryPool);
+
+    EXPECT_TRUE(allocateBitmapBlock(&memoryPool) == NULL);
+
+    releaseBitmapBlock(&memoryPool, blocks[2 * BITMAP_WORD_BITS + 5]);
+    releaseBitmapBlock(&memoryPool, blocks[BITMAP_WORD_BITS + 1]);
+    releaseBitmapBlock(&memoryPool, blocks[3]);
+
+    EXPECT_FALSE(isBitmapBlockAllocated(&memoryPool, blocks[3]));
+    EXPECT_TRUE(isBitmapBlockAllocated(&memoryPool, blocks[4]));
+
+    EXPECT_TRUE(allocateBitmapBlock(&memoryPool) == blocks[3]);
+    EXPECT_TRUE(allocateBitmapBlock(&memoryPool) == blocks[BITMAP_WORD_BITS + 1]);
+    EXPECT_TRUE(allocateBitmapBlock(&memoryPool) == blocks[2 * BITMAP_WORD_BITS + 5]);
+    EXPECT_TRUE(allocateBitmapBlock(&memoryPool) == NULL);
+
+    EXPECT_TRUE(isBitmapBlockAllocated(&memoryPool, blocks[3]));
+}
+
+TEST(BitmapMemoryPool, StressTest)
+{
+    const size_t numberOfBlocks = 1000;
+    size_t memoryRegion[(numberOfBlocks * 4) / sizeof(size_t) + 32];
+
+    BitmapMemoryPool memoryPool;
+    initializeBitmapMemoryPool(&memoryPool, memoryRegion, numberOfBlocks, 4);
+
+    uint32_t *blocks[numberOfBlocks];
+    for(size_t i = 0; i < numberOfBlocks; i++) {
+        blocks[i] = (uint32_t *) allocateBitmapBlock(&memoryPool);
+        ASSERT_TRUE(blocks[i] != NULL);
+        *blocks[i] = (uint32_t) i;
+    }
+
+    for(size_t round = 0; round < 100; round++) {
+        for(size_t i = round % 7; i < numberOfBlocks; i += 7) {
+            EXPECT_EQ(i, *blocks[i]);
+            releaseBitmapBlock(&memoryPool, blocks[i]);
+        }
+
+        for(size_t i = round % 7; i < numberOfBlocks; i += 7) {
+            blocks[i] = (uint32_t *) allocateBitmapBlock(&memoryPool);
+            ASSERT_TRUE(blocks[i] != NULL);
+            *blocks[i] = (uint32_t) i;
+        }
+
+        ASSERT_TRUE(allocateBitmapBlock(&memoryPool) == NULL);
+    }
+}
@@ -0,0 +1,141 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+#include "ConcurrentGrowingMemoryPool.h"
+#include "gtest.h"
+
+namespace
+{
+    struct Element
+    {
+        std::int64_t value;
+
+        Element() :
+            value(-1)
+        {
+        }
+    };
+
+    struct alignas(64) AlignedElement
+    {
+        std::int64_t value;
+    };
+}
+
+TEST(ConcurrentGrowingMemoryPool, GrowsByMemoryRegions)
+{
+    ConcurrentGrowingMemoryPool<Element> memoryPool(4);
+    std::set<Element *> elements;
+
+    for(int i = 0; i < 10; i++) {
+        Element *element = memoryPool.allocateBlock();
+        EXPECT_EQ(-1, element->value);
+        elements.insert(element);
+    }
+
+    EXPECT_EQ(10u, elements.size());
+
+    for(std::set<Element *>::iterator iterator = elements.begin(); iterator != elements.end(); ++iterator)
+        memoryPool.releaseBlock(*iterator);
+
+    // Released blocks are reused before the memory pool grows again
+    for(int i = 0; i < 10; i++)
+        EXPECT_TRUE(elements.count(memoryPool.allocateBlock()) == 1);
+}
+
+TEST(ConcurrentGrowingMemoryPool, AlignedBlocks)
+{
+    ConcurrentGrowingMemoryPool<AlignedElement> memoryPool(3);
+
+    EXPECT_EQ(64u, ConcurrentGrowingMemoryPool<AlignedElement>::FixedPool::alignedBlockSize);
+
+    for(int i = 0; i < 10; i++) {
+        AlignedElement *element = memoryPool.allocateBlock();
+        EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(element) % 64);
+    }
+}
+
+TEST(ConcurrentGrowingMemoryPool, ReleaseBlocks)
+{
+    ConcurrentGrowingMemoryPool<Element> memoryPool(8);
+    Element *elements[8];
+
+    for(int i = 0; i < 8; i++)
+        elements[i] = memoryPool.allocateBlock();
+
+    memoryPool.releaseBlocks(elements, 8);
+
+    for(int i = 0; i < 8; i++)
+        EXPECT_TRUE(memoryPool.allocateBlock() == elements[i]);
+}
+
+TEST(ConcurrentGrowingMemoryPool, MultipleThreads)
+{
+    const unsigned numberOfThreads = 8;
+    const unsigned blocksPerThread = 64;
+    const unsigned numberOfIterations = 4 * 1024;
+
+    ConcurrentGrowingMemoryPool<Element> memoryPool(16);
+
+    std::vector<unsigned> failures(numberOfThreads);
+    std::vector<std::thread> threads;
+
+    for(unsigned threadIndex = 0; threadIndex < numberOfThreads; threadIndex++) {
+        threads.push_back(std::thread([&, threadIndex]() {
+            Element *blocks[blocksPerThread];
+
+            for(unsigned iteration = 0; iteration < numberOfIterations; iteration++) {
+                unsigned count = 1 + iteration % blocksPerThread;
+
+                for(unsigned i = 0; i < count; i++) {
+                    blocks[i] = memoryPool.allocateBlock();
+                    blocks[i]->value = threadIndex;
+                }
+
+                for(unsigned i = 0; i < count; i++) {
+                    if(blocks[i]->value != threadIndex)
+                        failures[threadIndex]++;
+
+                    memoryPool.releaseBlock(blocks[i]);
+                }
+            }
+        }));
+    }
+
+    for(unsigned threadIndex = 0; threadIndex < numberOfThreads; threadIndex++) {
+        threads[threadIndex].join();
+        EXPECT_EQ(0u, failures[threadIndex]);
+    }
+}
@@ -0,0 +1,152 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <thread>
+#include <vector>
+#include "ConcurrentIndexedMemoryPool.h"
+#include "gtest.h"
+
+TEST(ConcurrentIndexedMemoryPool, EmptyMemoryRegion)
+{
+    ConcurrentIndexedMemoryPool memoryPool;
+    initializeConcurrentIndexedMemoryPool(&memoryPool, NULL, 16, 4);
+
+    EXPECT_TRUE(allocateIndexedBlockConcurrent(&memoryPool) == NULL);
+    EXPECT_EQ(INDEXED_MEMORY_POOL_NULL_INDEX, allocateIndexedBlockIndexConcurrent(&memoryPool));
+}
+
+TEST(ConcurrentIndexedMemoryPool, SimpleAllocScheme)
+{
+    uint32_t memoryRegion[6];
+
+    ConcurrentIndexedMemoryPool memoryPool;
+    initializeConcurrentIndexedMemoryPool(&memoryPool, memoryRegion, 3, 6);
+    EXPECT_EQ(8u, memoryPool.blockSize);
+
+    void *ptr1 = allocateIndexedBlockConcurrent(&memoryPool);
+    uint32_t index2 = allocateIndexedBlockIndexConcurrent(&memoryPool);
+    void *ptr3 = allocateIndexedBlockConcurrent(&memoryPool);
+
+    EXPECT_TRUE(ptr1 == &memoryRegion[0]);
+    EXPECT_EQ(1u, index2);
+    EXPECT_TRUE(getConcurrentIndexedBlock(&memoryPool, index2) == &memoryRegion[2]);
+    EXPECT_TRUE(ptr3 == &memoryRegion[4]);
+    EXPECT_EQ(2u, getIndexOfConcurrentIndexedBlock(&memoryPool, ptr3));
+    EXPECT_TRUE(allocateIndexedBlockConcurrent(&memoryPool) == NULL);
+
+    releaseIndexedBlockConcurrent(&memoryPool, ptr1);
+    releaseIndexedBlockIndexConcurrent(&memoryPool, index2);
+
+    EXPECT_EQ(index2, allocateIndexedBlockIndexConcurrent(&memoryPool));
+    EXPECT_TRUE(allocateIndexedBlockConcurrent(&memoryPool) == ptr1);
+    EXPECT_TRUE(allocateIndexedBlockConcurrent(&memoryPool) == NULL);
+}
+
+TEST(ConcurrentIndexedMemoryPool, RelocatedMemoryPool)
+{
+    // Memory pool and memory region copied together to other address, as if
+    // mapped there by other process
+    struct SharedMemory
+    {
+        ConcurrentIndexedMemoryPool memoryPool;
+        uint32_t memoryRegion[4];
+    };
+
+    SharedMemory sharedMemory;
+    initializeConcurrentIndexedMemoryPool(&sharedMemory.memoryPool,
+        sharedMemory.memoryRegion, 4, sizeof(uint32_t));
+
+    uint32_t index = allocateIndexedBlockIndexConcurrent(&sharedMemory.memoryPool);
+    releaseIndexedBlockIndexConcurrent(&sharedMemory.memoryPool,
+        allocateIndexedBlockIndexConcurrent(&sharedMemory.memoryPool));
+
+    SharedMemory relocatedMemory = sharedMemory;
+    EXPECT_TRUE(getConcurrentIndexedBlock(&relocatedMemory.memoryPool, index) ==
+        &relocatedMemory.memoryRegion[index]);
+    EXPECT_TRUE(allocateIndexedBlockConcurrent(&relocatedMemory.memoryPool) ==
+        &relocatedMemory.memoryRegion[1]);
+    EXPECT_TRUE(allocateIndexedBlockConcurrent(&relocatedMemory.memoryPool) ==
+        &relocatedMemory.memoryRegion[2]);
+}
+
+TEST(ConcurrentIndexedMemoryPool, MultipleThreads)
+{
+    const unsigned numberOfThreads = 8;
+    const unsigned blocksPerThread = 64;
+    const unsigned numberOfIterations = 16 * 1024;
+
+    std::vector<uint32_t> buffer(numberOfThreads * blocksPerThread);
+
+    ConcurrentIndexedMemoryPool memoryPool;
+    initializeConcurrentIndexedMemoryPool(&memoryPool, &buffer[0], buffer.size(), sizeof(buffer[0]));
+
+    std::vector<unsigned> failures(numberOfThreads);
+    std::vector<std::thread> threads;
+
+    for(unsigned threadIndex = 0; threadIndex < numberOfThreads; threadIndex++) {
+        threads.push_back(std::thread([&, threadIndex]() {
+            uint32_t indices[blocksPerThread];
+
+            for(unsigned iteration = 0; iteration < numberOfIterations; iteration++) {
+                unsigned count = 1 + iteration % blocksPerThread;
+
+                for(unsigned i = 0; i < count; i++) {
+                    indices[i] = allocateIndexedBlockIndexConcurrent(&memoryPool);
+                    if(indices[i] == INDEXED_MEMORY_POOL_NULL_INDEX)
+                        failures[threadIndex]++;
+                    else
+                        buffer[indices[i]] = threadIndex;
+                }
+
+                for(unsigned i = 0; i < count; i++) {
+                    if(indices[i] == INDEXED_MEMORY_POOL_NULL_INDEX)
+                        continue;
+
+                    if(buffer[indices[i]] != threadIndex)
+                        failures[threadIndex]++;
+
+                    releaseIndexedBlockIndexConcurrent(&memoryPool, indices[i]);
+                }
+            }
+        }));
+    }
+
+    for(unsigned threadIndex = 0; threadIndex < numberOfThreads; threadIndex++) {
+        threads[threadIndex].join();
+        EXPECT_EQ(0u, failures[threadIndex]);
+    }
+
+    unsigned numberOfBlocks = 0;
+    while(allocateIndexedBlockConcurrent(&memoryPool))
+        numberOfBlocks++;
+
+    EXPECT_EQ(buffer.size(), numberOfBlocks);
+}
@@ -0,0 +1,191 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <thread>
+#include <vector>
+#include "ConcurrentMemoryPool.h"
+#include "gtest.h"
+
+TEST(ConcurrentMemoryPool, EmptyMemoryRegion)
+{
+    ConcurrentMemoryPool memoryPool;
+    initializeConcurrentMemoryPool(&memoryPool, NULL, 0, 1024);
+
+    void *ptr1 = allocateBlockConcurrent(&memoryPool);
+    void *ptr2 = allocateBlockConcurrent(&memoryPool);
+
+    EXPECT_TRUE(ptr1 == NULL);
+    EXPECT_TRUE(ptr2 == NULL);
+}
+
+TEST(ConcurrentMemoryPool, SmallElement)
+{
+    uint8_t buffer;
+
+    ConcurrentMemoryPool memoryPool;
+    initializeConcurrentMemoryPool(&memoryPool, &buffer, 1, sizeof(buffer));
+
+    void *ptr = allocateBlockConcurrent(&memoryPool);
+
+    EXPECT_TRUE(ptr == NULL);
+}
+
+TEST(ConcurrentMemoryPool, SimpleAllocScheme)
+{
+    const size_t blockSize = 23;
+    const size_t numberOfBlocks = 3;
+    const size_t memoryRegionSize = numberOfBlocks * blockSize;
+    uint8_t memoryRegion[memoryRegionSize];
+
+    ConcurrentMemoryPool memoryPool;
+    initializeConcurrentMemoryPool(&memoryPool, memoryRegion, numberOfBlocks, blockSize);
+
+    void *ptr1 = allocateBlockConcurrent(&memoryPool);
+    void *ptr2 = allocateBlockConcurrent(&memoryPool);
+    void *ptr3 = allocateBlockConcurrent(&memoryPool);
+    void *ptr4 = allocateBlockConcurrent(&memoryPool);
+
+    EXPECT_TRUE(ptr1 == memoryRegion);
+    EXPECT_TRUE(ptr2 == memoryRegion + blockSize);
+    EXPECT_TRUE(ptr3 == memoryRegion + 2 * blockSize);
+    EXPECT_TRUE(ptr4 == NULL);
+
+    releaseBlockConcurrent(&memoryPool, ptr2);
+
+    void *ptr5 = allocateBlockConcurrent(&memoryPool);
+    void *ptr6 = allocateBlockConcurrent(&memoryPool);
+
+    EXPECT_TRUE(ptr5 == ptr2);
+    EXPECT_TRUE(ptr6 == NULL);
+}
+
+TEST(ConcurrentMemoryPool, ExtendMemoryPool)
+{
+    uint64_t region1;
+    uint64_t region2[2];
+
+    ConcurrentMemoryPool memoryPool;
+    initializeConcurrentMemoryPool(&memoryPool, &region1, 1, sizeof(region1));
+
+    EXPECT_FALSE(extendConcurrentMemoryPool(&memoryPool, region2, 2));
+
+    void *ptr1 = allocateBlockConcurrent(&memoryPool);
+    void *ptr2 = allocateBlockConcurrent(&memoryPool);
+
+    EXPECT_TRUE(ptr1 == &region1);
+    EXPECT_TRUE(ptr2 == NULL);
+
+    EXPECT_TRUE(extendConcurrentMemoryPool(&memoryPool, region2, 2));
+
+    void *ptr3 = allocateBlockConcurrent(&memoryPool);
+    void *ptr4 = allocateBlockConcurrent(&memoryPool);
+    void *ptr5 = allocateBlockConcurrent(&memoryPool);
+
+    EXPECT_TRUE(ptr3 == &region2[0]);
+    EXPECT_TRUE(ptr4 == &region2[1]);
+    EXPECT_TRUE(ptr5 == NULL);
+}
+
+TEST(ConcurrentMemoryPool, ReleaseBlocks)
+{
+    void *region[3];
+
+    ConcurrentMemoryPool memoryPool;
+    initializeConcurrentMemoryPool(&memoryPool, region, 3, sizeof(region[0]));
+
+    void *pointers[3];
+    for(unsigned i = 0; i < 3; i++)
+        pointers[i] = allocateBlockConcurrent(&memoryPool);
+
+    releaseBlocksConcurrent(&memoryPool, pointers, 0);
+    EXPECT_TRUE(allocateBlockConcurrent(&memoryPool) == NULL);
+
+    releaseBlocksConcurrent(&memoryPool, pointers, 3);
+
+    EXPECT_TRUE(allocateBlockConcurrent(&memoryPool) == &region[0]);
+    EXPECT_TRUE(allocateBlockConcurrent(&memoryPool) == &region[1]);
+    EXPECT_TRUE(allocateBlockConcurrent(&memoryPool) == &region[2]);
+    EXPECT_TRUE(allocateBlockConcurrent(&memoryPool) == NULL);
+}
+
+TEST(ConcurrentMemoryPool, MultipleThreads)
+{
+    const unsigned numberOfThreads = 8;
+    const unsigned blocksPerThread = 64;
+    const unsigned numberOfIterations = 16 * 1024;
+
+    std::vector<uint64_t> buffer(numberOfThreads * blocksPerThread);
+
+    ConcurrentMemoryPool memoryPool;
+    initializeConcurrentMemoryPool(&memoryPool, &buffer[0], buffer.size(), sizeof(buffer[0]));
+
+    std::vector<unsigned> failures(numberOfThreads);
+    std::vector<std::thread> threads;
+
+    for(unsigned threadIndex = 0; threadIndex < numberOfThreads; threadIndex++) {
+        threads.push_back(std::thread([&, threadIndex]() {
+            uint64_t *blocks[blocksPerThread];
+
+            for(unsigned iteration = 0; iteration < numberOfIterations; iteration++) {
+                unsigned count = 1 + iteration % blocksPerThread;
+
+                for(unsigned i = 0; i < count; i++) {
+                    blocks[i] = (uint64_t *) allocateBlockConcurrent(&memoryPool);
+                    if(!blocks[i])
+                        failures[threadIndex]++;
+                    else
+                        *blocks[i] = threadIndex;
+                }
+
+                for(unsigned i = 0; i < count; i++) {
+                    if(!blocks[i])
+                        continue;
+
+                    if(*blocks[i] != threadIndex)
+                        failures[threadIndex]++;
+
+                    releaseBlockConcurrent(&memoryPool, blocks[i]);
+                }
+            }
+        }));
+    }
+
+    for(unsigned threadIndex = 0; threadIndex < numberOfThreads; threadIndex++) {
+        threads[threadIndex].join();
+        EXPECT_EQ(0u, failures[threadIndex]);
+    }
+
+    unsigned numberOfBlocks = 0;
+    while(allocateBlockConcurrent(&memoryPool))
+        numberOfBlocks++;
+
+    EXPECT_EQ(buffer.size(), numberOfBlocks);
+}
@@ -0,0 +1,120 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <cstdint>
+#include "DynamicBitmapMemoryPool.h"
+#include "gtest.h"
+
+namespace
+{
+    struct Identifier
+    {
+        std::uint8_t value;
+
+        Identifier() :
+            value(7)
+        {
+        }
+    };
+
+    struct alignas(32) AlignedElement
+    {
+        std::int64_t value;
+    };
+}
+
+TEST(DynamicBitmapMemoryPool, BlocksWithoutPadding)
+{
+    DynamicBitmapMemoryPool<Identifier> memoryPool(100);
+
+    Identifier *first = memoryPool.allocateBlock();
+    Identifier *second = memoryPool.allocateBlock();
+
+    EXPECT_EQ(7, first->value);
+    EXPECT_TRUE(second == first + 1);
+    EXPECT_EQ(98u, memoryPool.getNumberOfFreeBlocks());
+}
+
+TEST(DynamicBitmapMemoryPool, ExhaustAndRelease)
+{
+    DynamicBitmapMemoryPool<Identifier> memoryPool(3);
+
+    Identifier *blocks[3];
+    for(int i = 0; i < 3; i++)
+        blocks[i] = memoryPool.allocateBlock();
+
+    EXPECT_TRUE(memoryPool.allocateBlock() == NULL);
+    EXPECT_TRUE(memoryPool.isAllocated(blocks[1]));
+
+    memoryPool.releaseBlock(blocks[1]);
+    EXPECT_FALSE(memoryPool.isAllocated(blocks[1]));
+    EXPECT_EQ(1u, memoryPool.getNumberOfFreeBlocks());
+
+    EXPECT_TRUE(memoryPool.allocateBlock() == blocks[1]);
+}
+
+TEST(DynamicBitmapMemoryPool, EmptyMemoryPool)
+{
+    DynamicBitmapMemoryPool<Identifier> memoryPool(0);
+
+    EXPECT_TRUE(memoryPool.allocateBlock() == NULL);
+    EXPECT_EQ(0u, memoryPool.getNumberOfFreeBlocks());
+}
+
+TEST(DynamicBitmapMemoryPool, AlignedBlocks)
+{
+    // Bitmap of 65 blocks takes two words, so the blocks would not be aligned
+    // without padding
+    DynamicBitmapMemoryPool<AlignedElement> memoryPool(65);
+
+    for(int i = 0; i < 65; i++) {
+        AlignedElement *element = memoryPool.allocateBlock();
+        ASSERT_TRUE(element != NULL);
+        EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(element) % 32);
+        element->value = i;
+    }
+
+    EXPECT_TRUE(memoryPool.allocateBlock() == NULL);
+}
+
+TEST(DynamicBitmapMemoryPool, GivenAlignment)
+{
+    typedef DynamicBitmapMemoryPool<Identifier, 16> IdentifierPool;
+    IdentifierPool memoryPool(10);
+
+    EXPECT_EQ(16u, IdentifierPool::alignedBlockSize);
+
+    Identifier *first = memoryPool.allocateBlock();
+    Identifier *second = memoryPool.allocateBlock();
+
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(first) % 16);
+    EXPECT_EQ(16, reinterpret_cast<std::uint8_t *>(second) - reinterpret_cast<std::uint8_t *>(first));
+}
@@ -0,0 +1,102 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <cstdint>
+#include <new>
+#include "DynamicHandleMemoryPool.h"
+#include "gtest.h"
+
+namespace
+{
+    struct Element
+    {
+        std::int64_t value;
+
+        Element() :
+            value(-1)
+        {
+        }
+    };
+
+    typedef DynamicHandleMemoryPool<Element> ElementPool;
+}
+
+TEST(DynamicHandleMemoryPool, AllocatesConstructedBlocks)
+{
+    ElementPool memoryPool(4);
+    ElementPool::Handle handles[4];
+
+    for(int i = 0; i < 4; i++) {
+        handles[i] = memoryPool.allocateBlock();
+        ASSERT_NE(ElementPool::nullHandle, handles[i]);
+
+        Element *element = memoryPool.resolve(handles[i]);
+        ASSERT_TRUE(element != NULL);
+        EXPECT_EQ(-1, element->value);
+        element->value = i;
+    }
+
+    EXPECT_EQ(ElementPool::nullHandle, memoryPool.allocateBlock());
+
+    for(int i = 0; i < 4; i++)
+        EXPECT_EQ(i, memoryPool.resolve(handles[i])->value);
+}
+
+TEST(DynamicHandleMemoryPool, DetectsStaleHandles)
+{
+    ElementPool memoryPool(1);
+
+    ElementPool::Handle handle = memoryPool.allocateBlock();
+    EXPECT_TRUE(memoryPool.releaseBlock(handle));
+    EXPECT_TRUE(memoryPool.resolve(handle) == NULL);
+    EXPECT_FALSE(memoryPool.releaseBlock(handle));
+
+    // The block is reused under other handle
+    ElementPool::Handle otherHandle = memoryPool.allocateBlock();
+    EXPECT_NE(handle, otherHandle);
+    EXPECT_TRUE(memoryPool.resolve(otherHandle) != NULL);
+    EXPECT_TRUE(memoryPool.resolve(handle) == NULL);
+}
+
+TEST(DynamicHandleMemoryPool, EmptyMemoryPool)
+{
+    ElementPool memoryPool(0);
+
+    EXPECT_EQ(ElementPool::nullHandle, memoryPool.allocateBlock());
+}
+
+TEST(DynamicHandleMemoryPool, ThrowsWhenMemoryRegionNotAllocated)
+{
+    if(sizeof(std::size_t) < sizeof(std::uint64_t))
+        return;
+
+    EXPECT_THROW(ElementPool(static_cast<std::size_t>(1) << 56), std::bad_alloc);
+}
@@ -0,0 +1,142 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include "DynamicMemoryPool.h"
+#include "gtest.h"
+
+namespace
+{
+    struct Element
+    {
+        std::int64_t value;
+
+        Element() :
+            value(-1)
+        {
+        }
+
+        Element(std::int64_t value) :
+            value(value)
+        {
+            if(value < 0)
+                throw std::invalid_argument("value");
+        }
+    };
+
+    typedef DynamicMemoryPool<Element> ElementPool;
+}
+
+TEST(DynamicMemoryPool, AllocateBlockWhenExhausted)
+{
+    ElementPool memoryPool(2);
+
+    Element *element1 = memoryPool.allocateBlock();
+    Element *element2 = memoryPool.construct(2);
+
+    EXPECT_EQ(-1, element1->value);
+    EXPECT_EQ(2, element2->value);
+    EXPECT_TRUE(memoryPool.allocateBlock() == NULL);
+    EXPECT_TRUE(memoryPool.construct(3) == NULL);
+
+    memoryPool.releaseBlock(element1);
+    memoryPool.releaseBlock(element2);
+}
+
+TEST(DynamicMemoryPool, NoBlocks)
+{
+    ElementPool memoryPool(0);
+
+    EXPECT_TRUE(memoryPool.allocateBlock() == NULL);
+    EXPECT_TRUE(memoryPool.construct(1) == NULL);
+}
+
+TEST(DynamicMemoryPool, ConstructorThrows)
+{
+    ElementPool memoryPool(1);
+
+    EXPECT_THROW(memoryPool.construct(-1), std::invalid_argument);
+
+    Element *element = memoryPool.construct(1);
+    ASSERT_TRUE(element != NULL);
+    EXPECT_TRUE(memoryPool.allocateBlock() == NULL);
+
+    memoryPool.releaseBlock(element);
+}
+
+TEST(DynamicMemoryPool, AllocateUninitialized)
+{
+    ElementPool memoryPool(1);
+
+    Element *element = memoryPool.allocateUninitialized();
+    ASSERT_TRUE(element != NULL);
+    EXPECT_TRUE(memoryPool.allocateUninitialized() == NULL);
+
+    memoryPool.releaseUninitialized(element);
+    EXPECT_EQ(element, memoryPool.allocateUninitialized());
+}
+
+TEST(DynamicMemoryPool, MoveConstructor)
+{
+    ElementPool source(2);
+    Element *element1 = source.construct(1);
+
+    ElementPool destination(std::move(source));
+    EXPECT_TRUE(source.allocateBlock() == NULL);
+
+    Element *element2 = destination.construct(2);
+    ASSERT_TRUE(element2 != NULL);
+    EXPECT_TRUE(destination.allocateBlock() == NULL);
+
+    destination.releaseBlock(element1);
+    destination.releaseBlock(element2);
+    EXPECT_EQ(element2, destination.allocateBlock());
+}
+
+TEST(DynamicMemoryPool, MoveAssignment)
+{
+    ElementPool source(1);
+    ElementPool destination(3);
+    Element *element = source.construct(1);
+
+    destination = std::move(source);
+    EXPECT_TRUE(source.allocateBlock() == NULL);
+    EXPECT_TRUE(destination.allocateBlock() == NULL);
+
+    destination.releaseBlock(element);
+
+    ElementPool &self = destination;
+    destination = std::move(self);
+    EXPECT_EQ(element, destination.construct(2));
+    EXPECT_EQ(2, element->value);
+}
@@ -0,0 +1,138 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "EpochMemoryPool.h"
+#include "gtest.h"
+
+namespace
+{
+    // Value is overwritten when the node is destructed or reused
+    struct Node
+    {
+        std::atomic<std::int64_t> value;
+
+        Node() :
+            value(-1)
+        {
+        }
+
+        ~Node()
+        {
+            value = -2;
+        }
+    };
+}
+
+TEST(EpochMemoryPool, RetiredBlockNotReusedWhileGuarded)
+{
+    EpochMemoryPool<Node> memoryPool(16, 4);
+    EpochMemoryPool<Node>::Participant reader(memoryPool);
+    EpochMemoryPool<Node>::Participant retirer(memoryPool);
+
+    Node *node = memoryPool.allocateBlock();
+    node->value = 1;
+
+    {
+        EpochMemoryPool<Node>::Guard guard(reader);
+        retirer.retireBlock(node);
+
+        for(int i = 0; i < 1000; i++) {
+            Node *other = memoryPool.allocateBlock();
+            EXPECT_TRUE(other != node);
+            retirer.retireBlock(other);
+        }
+
+        EXPECT_EQ(1, node->value);
+    }
+
+    // Once the reader leaves, the block is returned to the memory pool
+    bool isReused = false;
+    for(int i = 0; i < 1000 && !isReused; i++) {
+        Node *other = memoryPool.allocateBlock();
+        isReused = other == node;
+        retirer.retireBlock(other);
+    }
+
+    EXPECT_TRUE(isReused);
+}
+
+TEST(EpochMemoryPool, ConcurrentReadersAndRetirer)
+{
+    const int numberOfReaders = 4;
+    const std::int64_t numberOfUpdates = 100000;
+
+    EpochMemoryPool<Node> memoryPool(64, 16);
+    std::atomic<Node *> current(memoryPool.allocateBlock());
+    std::atomic<bool> isDone(false);
+    std::vector<int> failures(numberOfReaders, 0);
+    std::vector<std::thread> threads;
+
+    current.load()->value = 0;
+
+    for(int i = 0; i < numberOfReaders; i++)
+        threads.push_back(std::thread([&, i]() {
+            EpochMemoryPool<Node>::Participant participant(memoryPool);
+
+            while(!isDone) {
+                EpochMemoryPool<Node>::Guard guard(participant);
+                Node *node = current.load();
+                std::int64_t value = node->value;
+
+                // The node may be retired meanwhile, but must stay intact
+                for(int j = 0; j < 16; j++)
+                    if(node->value != value || value < 0)
+                        failures[i]++;
+            }
+        }));
+
+    {
+        EpochMemoryPool<Node>::Participant participant(memoryPool);
+
+        for(std::int64_t i = 1; i <= numberOfUpdates; i++) {
+            Node *node = memoryPool.allocateBlock();
+            node->value = i;
+            participant.retireBlock(current.exchange(node));
+        }
+
+        isDone = true;
+        for(std::size_t i = 0; i < threads.size(); i++)
+            threads[i].join();
+
+        participant.retireBlock(current.exchange(NULL));
+    }
+
+    for(int i = 0; i < numberOfReaders; i++)
+        EXPECT_EQ(0, failures[i]);
+}
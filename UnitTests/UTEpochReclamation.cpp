@@ -0,0 +1,172 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "EpochReclamation.h"
+#include "ConcurrentMemoryPool.h"
+#include "gtest.h"
+
+TEST(EpochReclamation, RetireAndCollect)
+{
+    void *retiredBlocks[4];
+    void *pointers[4];
+    int blocks[4];
+
+    EpochDomain epochDomain;
+    initializeEpochDomain(&epochDomain);
+
+    EpochParticipant participant;
+    initializeEpochParticipant(&participant, retiredBlocks, 4);
+    addEpochParticipant(&epochDomain, &participant);
+
+    EXPECT_EQ(1, retireBlock(&epochDomain, &participant, &blocks[0]));
+    EXPECT_EQ(1, retireBlock(&epochDomain, &participant, &blocks[1]));
+
+    // Two epochs have to pass before blocks are safe
+    EXPECT_EQ(0u, collectRetiredBlocks(&epochDomain, &participant, pointers, 4));
+    EXPECT_EQ(1, retireBlock(&epochDomain, &participant, &blocks[2]));
+    EXPECT_EQ(2u, collectRetiredBlocks(&epochDomain, &participant, pointers, 4));
+    EXPECT_TRUE(pointers[0] == &blocks[0]);
+    EXPECT_TRUE(pointers[1] == &blocks[1]);
+
+    EXPECT_EQ(1u, collectRetiredBlocks(&epochDomain, &participant, pointers, 4));
+    EXPECT_TRUE(pointers[0] == &blocks[2]);
+    EXPECT_EQ(0u, participant.numberOfRetiredBlocks);
+}
+
+TEST(EpochReclamation, ReaderHoldsEpoch)
+{
+    void *retiredBlocks[2];
+    void *pointers[2];
+    int blocks[3];
+
+    EpochDomain epochDomain;
+    initializeEpochDomain(&epochDomain);
+
+    EpochParticipant reader;
+    initializeEpochParticipant(&reader, NULL, 0);
+    addEpochParticipant(&epochDomain, &reader);
+
+    EpochParticipant writer;
+    initializeEpochParticipant(&writer, retiredBlocks, 2);
+    addEpochParticipant(&epochDomain, &writer);
+
+    enterEpoch(&epochDomain, &reader);
+    enterEpoch(&epochDomain, &reader);
+
+    EXPECT_EQ(1, retireBlock(&epochDomain, &writer, &blocks[0]));
+    EXPECT_EQ(1, retireBlock(&epochDomain, &writer, &blocks[1]));
+    EXPECT_EQ(0, retireBlock(&epochDomain, &writer, &blocks[2]));
+
+    for(unsigned i = 0; i < 4; i++)
+        EXPECT_EQ(0u, collectRetiredBlocks(&epochDomain, &writer, pointers, 2));
+
+    // Nested critical section keeps the epoch
+    leaveEpoch(&reader);
+    EXPECT_EQ(0u, collectRetiredBlocks(&epochDomain, &writer, pointers, 2));
+
+    leaveEpoch(&reader);
+    EXPECT_EQ(2u, collectRetiredBlocks(&epochDomain, &writer, pointers, 2));
+    EXPECT_EQ(1, retireBlock(&epochDomain, &writer, &blocks[2]));
+}
+
+TEST(EpochReclamation, ConcurrentReaders)
+{
+    const unsigned numberOfReaders = 4;
+    const unsigned numberOfUpdates = 64 * 1024;
+    const unsigned numberOfBlocks = 256;
+    const uint64_t validValue = 0x1234;
+
+    std::vector<uint64_t> buffer(numberOfBlocks);
+
+    ConcurrentMemoryPool memoryPool;
+    initializeConcurrentMemoryPool(&memoryPool, &buffer[0], buffer.size(), sizeof(buffer[0]));
+
+    EpochDomain epochDomain;
+    initializeEpochDomain(&epochDomain);
+
+    uint64_t *volatile sharedBlock = (uint64_t *) allocateBlockConcurrent(&memoryPool);
+    *sharedBlock = validValue;
+
+    std::atomic<bool> isDone(false);
+    std::vector<unsigned> failures(numberOfReaders);
+    std::vector<std::thread> threads;
+
+    for(unsigned threadIndex = 0; threadIndex < numberOfReaders; threadIndex++) {
+        threads.push_back(std::thread([&, threadIndex]() {
+            EpochParticipant participant;
+            initializeEpochParticipant(&participant, NULL, 0);
+            addEpochParticipant(&epochDomain, &participant);
+
+            while(!isDone) {
+                enterEpoch(&epochDomain, &participant);
+                uint64_t *block = sharedBlock;
+                for(unsigned i = 0; i < 16; i++)
+                    if(*(volatile uint64_t *) block != validValue)
+                        failures[threadIndex]++;
+                leaveEpoch(&participant);
+            }
+        }));
+    }
+
+    // Replaced blocks are reused as soon as collected
+    void *retiredBlocks[numberOfBlocks];
+    void *pointers[numberOfBlocks];
+
+    EpochParticipant writer;
+    initializeEpochParticipant(&writer, retiredBlocks, numberOfBlocks);
+    addEpochParticipant(&epochDomain, &writer);
+
+    for(unsigned update = 0; update < numberOfUpdates; update++) {
+        uint64_t *block = (uint64_t *) allocateBlockConcurrent(&memoryPool);
+        while(!block) {
+            size_t numberOfCollectedBlocks = collectRetiredBlocks(&epochDomain, &writer,
+                pointers, numberOfBlocks);
+            for(size_t i = 0; i < numberOfCollectedBlocks; i++)
+                *(uint64_t *) pointers[i] = 0;
+            releaseBlocksConcurrent(&memoryPool, pointers, numberOfCollectedBlocks);
+            block = (uint64_t *) allocateBlockConcurrent(&memoryPool);
+        }
+
+        *block = validValue;
+        uint64_t *previousBlock = (uint64_t *) atomicExchangePointer(
+            (void *volatile *) &sharedBlock, block);
+        EXPECT_EQ(1, retireBlock(&epochDomain, &writer, previousBlock));
+    }
+
+    isDone = true;
+    for(unsigned threadIndex = 0; threadIndex < numberOfReaders; threadIndex++) {
+        threads[threadIndex].join();
+        EXPECT_EQ(0u, failures[threadIndex]);
+    }
+}
@@ -0,0 +1,273 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "GrowingMemoryPool.h"
+#include "gtest.h"
+
+namespace
+{
+    struct Element
+    {
+        std::int64_t value;
+
+        Element() :
+            value(-1)
+        {
+        }
+
+        Element(std::int64_t value) :
+            value(value)
+        {
+            if(value < 0)
+                throw std::invalid_argument("value");
+        }
+    };
+
+    typedef GrowingMemoryPool<Element> ElementPool;
+
+    // Gives access to the underlying memory pool for C functions
+    class InspectedPool : public ElementPool
+    {
+        public:
+
+            InspectedPool(std::size_t growByNumberOfBlocks) :
+                ElementPool(growByNumberOfBlocks)
+            {
+            }
+
+            MemoryPool *getMemoryPool()
+            {
+                return this;
+            }
+    };
+
+    const std::size_t regionSize = ElementPool::FixedPool::getMemoryRegionSize(4);
+
+    std::vector<Element *> allocateBlocks(ElementPool &memoryPool, std::size_t numberOfBlocks)
+    {
+        std::vector<Element *> elements;
+        for(std::size_t i = 0; i < numberOfBlocks; i++)
+            elements.push_back(memoryPool.allocateBlock());
+
+        return elements;
+    }
+}
+
+TEST(GrowingMemoryPool, Grow)
+{
+    ElementPool memoryPool(2);
+    std::vector<Element *> elements;
+
+    for(int i = 0; i < 5; i++) {
+        elements.push_back(memoryPool.construct(i));
+        EXPECT_EQ(i, elements.back()->value);
+    }
+
+    for(std::size_t i = 0; i < elements.size(); i++)
+        memoryPool.releaseBlock(elements[i]);
+}
+
+TEST(GrowingMemoryPool, ConstructorThrows)
+{
+    ElementPool memoryPool(1);
+
+    Element *element1 = memoryPool.construct(1);
+    memoryPool.releaseBlock(element1);
+
+    EXPECT_THROW(memoryPool.construct(-1), std::invalid_argument);
+
+    // The block is given back to the memory pool
+    Element *element2 = memoryPool.construct(2);
+    EXPECT_EQ(element1, element2);
+
+    memoryPool.releaseBlock(element2);
+}
+
+TEST(GrowingMemoryPool, AllocateUninitialized)
+{
+    ElementPool memoryPool(1);
+
+    Element *element = memoryPool.allocateUninitialized();
+    memoryPool.releaseUninitialized(element);
+
+    EXPECT_EQ(element, memoryPool.allocateBlock());
+    EXPECT_EQ(-1, element->value);
+
+    memoryPool.releaseBlock(element);
+}
+
+TEST(GrowingMemoryPool, MoveConstructor)
+{
+    ElementPool source(2);
+    Element *element1 = source.construct(1);
+    Element *element2 = source.construct(2);
+    source.releaseBlock(element2);
+
+    ElementPool destination(std::move(source));
+    EXPECT_EQ(element2, destination.construct(3));
+
+    // Moved from memory pool grows again
+    Element *element3 = source.construct(4);
+    ASSERT_TRUE(element3 != NULL);
+    EXPECT_NE(element1, element3);
+    EXPECT_NE(element2, element3);
+    source.releaseBlock(element3);
+
+    destination.releaseBlock(element1);
+    destination.releaseBlock(element2);
+}
+
+TEST(GrowingMemoryPool, MoveAssignment)
+{
+    ElementPool source(2);
+    ElementPool destination(2);
+    Element *element1 = source.construct(1);
+    destination.construct(2);
+
+    // Memory regions of destination are released
+    destination = std::move(source);
+    destination.releaseBlock(element1);
+    EXPECT_EQ(element1, destination.construct(3));
+
+    ElementPool &self = destination;
+    destination = std::move(self);
+    destination.releaseBlock(element1);
+    EXPECT_EQ(element1, destination.allocateBlock());
+    destination.releaseBlock(element1);
+
+    EXPECT_TRUE(source.construct(4) != NULL);
+}
+
+TEST(GrowingMemoryPool, TrimReleasesFreeRegion)
+{
+    ElementPool memoryPool(4);
+    std::vector<Element *> elements = allocateBlocks(memoryPool, 8);
+
+    for(std::size_t i = 0; i < 4; i++)
+        memoryPool.releaseBlock(elements[i]);
+
+    EXPECT_EQ(regionSize, memoryPool.trim());
+    EXPECT_EQ(0u, memoryPool.trim());
+
+    for(std::size_t i = 4; i < 8; i++)
+        memoryPool.releaseBlock(elements[i]);
+
+    EXPECT_EQ(regionSize, memoryPool.trim());
+}
+
+TEST(GrowingMemoryPool, TrimKeepsPartiallyUsedRegion)
+{
+    ElementPool memoryPool(4);
+    std::vector<Element *> elements = allocateBlocks(memoryPool, 8);
+
+    for(std::size_t i = 0; i < 3; i++)
+        memoryPool.releaseBlock(elements[i]);
+    memoryPool.releaseBlock(elements[4]);
+
+    EXPECT_EQ(0u, memoryPool.trim());
+
+    // Free blocks are kept in the list
+    std::vector<Element *> reused = allocateBlocks(memoryPool, 4);
+    for(std::size_t i = 0; i < 4; i++) {
+        EXPECT_TRUE(reused[i] == elements[0] || reused[i] == elements[1] ||
+            reused[i] == elements[2] || reused[i] == elements[4]);
+    }
+}
+
+TEST(GrowingMemoryPool, TrimNotYetUsedRegion)
+{
+    ElementPool memoryPool(4);
+
+    // Region holds single released block and three never used ones
+    Element *element = memoryPool.allocateBlock();
+    memoryPool.releaseBlock(element);
+
+    EXPECT_EQ(regionSize, memoryPool.trim());
+    EXPECT_EQ(0u, memoryPool.trim());
+}
+
+TEST(GrowingMemoryPool, AllocateAfterTrim)
+{
+    ElementPool memoryPool(4);
+    std::vector<Element *> elements = allocateBlocks(memoryPool, 6);
+
+    for(std::size_t i = 0; i < 4; i++)
+        memoryPool.releaseBlock(elements[i]);
+    memoryPool.releaseBlock(elements[5]);
+
+    EXPECT_EQ(regionSize, memoryPool.trim());
+
+    // Block of the kept region and its never used blocks come first
+    std::vector<Element *> reused = allocateBlocks(memoryPool, 3);
+    EXPECT_EQ(elements[5], reused[0]);
+
+    std::vector<Element *> grown = allocateBlocks(memoryPool, 4);
+    for(std::size_t i = 0; i < grown.size(); i++) {
+        grown[i]->value = static_cast<std::int64_t>(i);
+        memoryPool.releaseBlock(grown[i]);
+    }
+    for(std::size_t i = 0; i < reused.size(); i++)
+        memoryPool.releaseBlock(reused[i]);
+    memoryPool.releaseBlock(elements[4]);
+
+    EXPECT_EQ(2 * regionSize, memoryPool.trim());
+}
+
+TEST(GrowingMemoryPool, MergeAfterTrim)
+{
+    InspectedPool memoryPool(4);
+    std::vector<Element *> elements = allocateBlocks(memoryPool, 8);
+
+    // First region is released, two blocks of the second one stay free
+    for(std::size_t i = 0; i < 4; i++)
+        memoryPool.releaseBlock(elements[i]);
+    memoryPool.releaseBlock(elements[5]);
+    memoryPool.releaseBlock(elements[6]);
+
+    EXPECT_EQ(regionSize, memoryPool.trim());
+
+    Element buffer[2];
+    MemoryPool destination;
+    initializeMemoryPool(&destination, buffer, 2, sizeof(Element));
+    releaseBlock(&destination, allocateBlock(&destination));
+
+    ASSERT_TRUE(mergeMemoryPools(&destination, memoryPool.getMemoryPool()) != 0);
+
+    std::vector<void *> blocks;
+    for(void *block = allocateBlock(&destination); block; block = allocateBlock(&destination))
+        blocks.push_back(block);
+
+    EXPECT_EQ(4u, blocks.size());
+}
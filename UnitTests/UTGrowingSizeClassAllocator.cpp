@@ -0,0 +1,111 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include <vector>
+#include "GrowingSizeClassAllocator.h"
+#include "gtest.h"
+
+TEST(GrowingSizeClassAllocator, GrowsEachSizeClass)
+{
+    GrowingSizeClassAllocator allocator(4);
+    const std::size_t sizes[] = { 1, 16, 17, 100, 512, 1024 };
+    std::vector<void *> blocks;
+    std::set<void *> distinctBlocks;
+
+    for(std::size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for(int j = 0; j < 10; j++) {
+            void *block = allocator.allocateBlock(sizes[i]);
+            ASSERT_TRUE(block != NULL);
+            std::memset(block, static_cast<int>(i), sizes[i]);
+
+            blocks.push_back(block);
+            distinctBlocks.insert(block);
+        }
+    }
+
+    EXPECT_EQ(blocks.size(), distinctBlocks.size());
+
+    for(std::size_t i = 0; i < blocks.size(); i++)
+        allocator.releaseBlock(blocks[i], sizes[i / 10]);
+}
+
+TEST(GrowingSizeClassAllocator, ReusesReleasedBlock)
+{
+    GrowingSizeClassAllocator allocator(4);
+
+    void *block = allocator.allocateBlock(40);
+    allocator.releaseBlock(block, 40);
+
+    // Sizes of the same size class share the memory pool
+    EXPECT_TRUE(allocator.allocateBlock(33) == block);
+    EXPECT_TRUE(allocator.allocateBlock(48) != block);
+}
+
+TEST(GrowingSizeClassAllocator, LargeBlock)
+{
+    GrowingSizeClassAllocator allocator(4);
+
+    void *block = allocator.allocateBlock(4096);
+    ASSERT_TRUE(block != NULL);
+    std::memset(block, 0, 4096);
+
+    allocator.releaseBlock(block, 4096);
+}
+
+TEST(GrowingSizeClassAllocator, CustomSizeClasses)
+{
+    const std::size_t blockSizes[] = { 8, 64 };
+    GrowingSizeClassAllocator allocator(2, blockSizes, 2);
+
+    void *small = allocator.allocateBlock(8);
+    void *large = allocator.allocateBlock(64);
+    void *bigger = allocator.allocateBlock(65);
+
+    ASSERT_TRUE(small != NULL);
+    ASSERT_TRUE(large != NULL);
+    ASSERT_TRUE(bigger != NULL);
+    std::memset(large, 0, 64);
+    std::memset(bigger, 0, 65);
+
+    allocator.releaseBlock(small, 8);
+    allocator.releaseBlock(large, 64);
+    allocator.releaseBlock(bigger, 65);
+}
+
+TEST(GrowingSizeClassAllocator, RejectsUnsortedSizeClasses)
+{
+    const std::size_t blockSizes[] = { 64, 8 };
+
+    EXPECT_THROW(GrowingSizeClassAllocator(2, blockSizes, 2), std::invalid_argument);
+}
@@ -0,0 +1,120 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <vector>
+#include <cstring>
+#include "HandleMemoryPool.h"
+#include "gtest.h"
+
+TEST(HandleMemoryPool, EmptyMemoryRegion)
+{
+    HandleMemoryPool memoryPool;
+    initializeHandleMemoryPool(&memoryPool, NULL, 16, 4);
+
+    EXPECT_EQ(HANDLE_MEMORY_POOL_NULL_HANDLE, allocateHandleBlock(&memoryPool));
+    EXPECT_TRUE(resolveHandle(&memoryPool, HANDLE_MEMORY_POOL_NULL_HANDLE) == NULL);
+    EXPECT_TRUE(resolveHandle(&memoryPool, 0) == NULL);
+}
+
+TEST(HandleMemoryPool, MemoryRegionSize)
+{
+    EXPECT_EQ(3 * (4 + sizeof(uint16_t)), getHandleMemoryRegionSize(3, 1));
+    EXPECT_EQ(3 * (8 + sizeof(uint16_t)), getHandleMemoryRegionSize(3, 6));
+}
+
+TEST(HandleMemoryPool, StaleHandle)
+{
+    std::vector<uint8_t> memoryRegion(getHandleMemoryRegionSize(2, sizeof(uint32_t)));
+
+    HandleMemoryPool memoryPool;
+    initializeHandleMemoryPool(&memoryPool, &memoryRegion[0], 2, sizeof(uint32_t));
+
+    uint32_t handle1 = allocateHandleBlock(&memoryPool);
+    uint32_t handle2 = allocateHandleBlock(&memoryPool);
+
+    EXPECT_TRUE(resolveHandle(&memoryPool, handle1) == &memoryRegion[0]);
+    EXPECT_TRUE(resolveHandle(&memoryPool, handle2) == &memoryRegion[4]);
+    EXPECT_EQ(HANDLE_MEMORY_POOL_NULL_HANDLE, allocateHandleBlock(&memoryPool));
+
+    EXPECT_EQ(1, releaseHandleBlock(&memoryPool, handle1));
+    EXPECT_TRUE(resolveHandle(&memoryPool, handle1) == NULL);
+    EXPECT_EQ(0, releaseHandleBlock(&memoryPool, handle1));
+
+    // The same block is reused under new handle
+    uint32_t handle3 = allocateHandleBlock(&memoryPool);
+    EXPECT_NE(handle1, handle3);
+    EXPECT_EQ(handle1 & HANDLE_MEMORY_POOL_INDEX_MASK, handle3 & HANDLE_MEMORY_POOL_INDEX_MASK);
+    EXPECT_TRUE(resolveHandle(&memoryPool, handle3) == &memoryRegion[0]);
+    EXPECT_TRUE(resolveHandle(&memoryPool, handle1) == NULL);
+}
+
+TEST(HandleMemoryPool, GenerationWrapAround)
+{
+    std::vector<uint8_t> memoryRegion(getHandleMemoryRegionSize(1, sizeof(uint32_t)));
+
+    HandleMemoryPool memoryPool;
+    initializeHandleMemoryPool(&memoryPool, &memoryRegion[0], 1, sizeof(uint32_t));
+
+    uint32_t firstHandle = allocateHandleBlock(&memoryPool);
+    uint32_t handle = firstHandle;
+
+    for(uint32_t i = 0; i < HANDLE_MEMORY_POOL_GENERATION_MASK; i++) {
+        EXPECT_EQ(1, releaseHandleBlock(&memoryPool, handle));
+        handle = allocateHandleBlock(&memoryPool);
+        EXPECT_NE(firstHandle, handle);
+        EXPECT_NE(HANDLE_MEMORY_POOL_NULL_HANDLE, handle);
+    }
+
+    EXPECT_EQ(1, releaseHandleBlock(&memoryPool, handle));
+    EXPECT_EQ(firstHandle, allocateHandleBlock(&memoryPool));
+}
+
+TEST(HandleMemoryPool, Relocation)
+{
+    std::vector<uint8_t> memoryRegion(getHandleMemoryRegionSize(4, sizeof(uint32_t)));
+
+    HandleMemoryPool memoryPool;
+    initializeHandleMemoryPool(&memoryPool, &memoryRegion[0], 4, sizeof(uint32_t));
+
+    uint32_t handle1 = allocateHandleBlock(&memoryPool);
+    uint32_t handle2 = allocateHandleBlock(&memoryPool);
+    *(uint32_t *) resolveHandle(&memoryPool, handle2) = 1234;
+    releaseHandleBlock(&memoryPool, handle1);
+
+    std::vector<uint8_t> relocatedRegion(memoryRegion);
+    std::memset(&memoryRegion[0], 0xFF, memoryRegion.size());
+    relocateHandleMemoryPool(&memoryPool, &relocatedRegion[0]);
+
+    EXPECT_TRUE(resolveHandle(&memoryPool, handle1) == NULL);
+    EXPECT_TRUE(resolveHandle(&memoryPool, handle2) == &relocatedRegion[4]);
+    EXPECT_EQ(1234u, *(uint32_t *) resolveHandle(&memoryPool, handle2));
+    EXPECT_TRUE(resolveHandle(&memoryPool, allocateHandleBlock(&memoryPool)) == &relocatedRegion[0]);
+}
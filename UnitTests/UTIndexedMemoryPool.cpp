@@ -0,0 +1,139 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "IndexedMemoryPool.h"
+#include "gtest.h"
+
+TEST(IndexedMemoryPool, EmptyMemoryRegion)
+{
+    IndexedMemoryPool memoryPool;
+    initializeIndexedMemoryPool(&memoryPool, NULL, 0, 4);
+
+    EXPECT_TRUE(allocateIndexedBlock(&memoryPool) == NULL);
+    EXPECT_EQ(INDEXED_MEMORY_POOL_NULL_INDEX, allocateIndexedBlockIndex(&memoryPool));
+}
+
+TEST(IndexedMemoryPool, BlockSizeRounding)
+{
+    uint32_t memoryRegion[4];
+
+    IndexedMemoryPool memoryPool;
+    initializeIndexedMemoryPool(&memoryPool, memoryRegion, 2, 1);
+    EXPECT_EQ(4u, memoryPool.blockSize);
+
+    initializeIndexedMemoryPool(&memoryPool, memoryRegion, 2, 6);
+    EXPECT_EQ(8u, memoryPool.blockSize);
+
+    IndexedMemoryPool16 memoryPool16;
+    initializeIndexedMemoryPool16(&memoryPool16, memoryRegion, 2, 1);
+    EXPECT_EQ(2u, memoryPool16.blockSize);
+
+    initializeIndexedMemoryPool16(&memoryPool16, memoryRegion, 2, 0);
+    EXPECT_EQ(2u, memoryPool16.blockSize);
+}
+
+TEST(IndexedMemoryPool, FourByteBlocks)
+{
+    const size_t numberOfBlocks = 16;
+    uint32_t memoryRegion[numberOfBlocks];
+
+    IndexedMemoryPool memoryPool;
+    initializeIndexedMemoryPool(&memoryPool, memoryRegion, numberOfBlocks, sizeof(uint32_t));
+
+    for(size_t i = 0; i < numberOfBlocks; i++)
+        EXPECT_TRUE(allocateIndexedBlock(&memoryPool) == &memoryRegion[i]);
+
+    EXPECT_TRUE(allocateIndexedBlock(&memoryPool) == NULL);
+
+    releaseIndexedBlock(&memoryPool, &memoryRegion[3]);
+    releaseIndexedBlock(&memoryPool, &memoryRegion[7]);
+
+    EXPECT_TRUE(allocateIndexedBlock(&memoryPool) == &memoryRegion[7]);
+    EXPECT_TRUE(allocateIndexedBlock(&memoryPool) == &memoryRegion[3]);
+    EXPECT_TRUE(allocateIndexedBlock(&memoryPool) == NULL);
+}
+
+TEST(IndexedMemoryPool, BlockIndices)
+{
+    uint32_t memoryRegion[8];
+
+    IndexedMemoryPool memoryPool;
+    initializeIndexedMemoryPool(&memoryPool, memoryRegion, 4, 8);
+
+    EXPECT_EQ(0u, allocateIndexedBlockIndex(&memoryPool));
+    EXPECT_EQ(1u, allocateIndexedBlockIndex(&memoryPool));
+    EXPECT_TRUE(getIndexedBlock(&memoryPool, 1) == &memoryRegion[2]);
+    EXPECT_EQ(3u, getIndexOfIndexedBlock(&memoryPool, &memoryRegion[6]));
+
+    releaseIndexedBlockIndex(&memoryPool, 0);
+    EXPECT_EQ(0u, allocateIndexedBlockIndex(&memoryPool));
+    EXPECT_EQ(2u, allocateIndexedBlockIndex(&memoryPool));
+}
+
+TEST(IndexedMemoryPool, TwoByteBlocks)
+{
+    const size_t numberOfBlocks = 100;
+    uint16_t memoryRegion[numberOfBlocks];
+    uint16_t *blocks[numberOfBlocks];
+
+    IndexedMemoryPool16 memoryPool;
+    initializeIndexedMemoryPool16(&memoryPool, memoryRegion, numberOfBlocks, sizeof(uint16_t));
+
+    for(size_t i = 0; i < numberOfBlocks; i++) {
+        blocks[i] = (uint16_t *) allocateIndexedBlock16(&memoryPool);
+        ASSERT_TRUE(blocks[i] == &memoryRegion[i]);
+    }
+
+    EXPECT_TRUE(allocateIndexedBlock16(&memoryPool) == NULL);
+    EXPECT_EQ(INDEXED_MEMORY_POOL16_NULL_INDEX, allocateIndexedBlockIndex16(&memoryPool));
+
+    for(size_t i = 0; i < numberOfBlocks; i += 2)
+        releaseIndexedBlock16(&memoryPool, blocks[i]);
+
+    for(size_t i = 0; i < numberOfBlocks / 2; i++)
+        EXPECT_TRUE(allocateIndexedBlock16(&memoryPool) == blocks[numberOfBlocks - 2 - 2 * i]);
+
+    EXPECT_TRUE(allocateIndexedBlock16(&memoryPool) == NULL);
+}
+
+TEST(IndexedMemoryPool, MaxNumberOfBlocks16)
+{
+    static uint16_t memoryRegion[0x10000];
+
+    IndexedMemoryPool16 memoryPool;
+    initializeIndexedMemoryPool16(&memoryPool, memoryRegion, 0x10000, sizeof(uint16_t));
+
+    size_t numberOfBlocks = 0;
+    while(allocateIndexedBlockIndex16(&memoryPool) != INDEXED_MEMORY_POOL16_NULL_INDEX)
+        numberOfBlocks++;
+
+    EXPECT_EQ(0xFFFFu, numberOfBlocks);
+}
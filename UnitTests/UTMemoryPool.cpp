@@ -181,3 +181,426 @@ TEST(MemoryPool, StressTest)
         }
     }
 }
+
+TEST(MemoryPool, BatchAllocation)
+{
+    uint64_t buffer[4];
+
+    MemoryPool memoryPool;
+    initializeMemoryPool(&memoryPool, buffer, 4, sizeof(buffer[0]));
+
+    void *pointers[8];
+    size_t numberOfBlocks = allocateBlocks(&memoryPool, pointers, 3);
+
+    EXPECT_EQ(3u, numberOfBlocks);
+    EXPECT_TRUE(pointers[0] == &buffer[0]);
+    EXPECT_TRUE(pointers[1] == &buffer[1]);
+    EXPECT_TRUE(pointers[2] == &buffer[2]);
+
+    numberOfBlocks = allocateBlocks(&memoryPool, pointers, 8);
+
+    EXPECT_EQ(1u, numberOfBlocks);
+    EXPECT_TRUE(pointers[0] == &buffer[3]);
+    EXPECT_EQ(0u, allocateBlocks(&memoryPool, pointers, 8));
+}
+
+TEST(MemoryPool, BatchRelease)
+{
+    uint64_t buffer[4];
+
+    MemoryPool memoryPool;
+    initializeMemoryPool(&memoryPool, buffer, 4, sizeof(buffer[0]));
+
+    void *pointers[8];
+    EXPECT_EQ(4u, allocateBlocks(&memoryPool, pointers, 4));
+
+    releaseBlocks(&memoryPool, pointers + 1, 2);
+    releaseBlocks(&memoryPool, pointers, 0);
+
+    void *ptr1 = allocateBlock(&memoryPool);
+    void *ptr2 = allocateBlock(&memoryPool);
+    void *ptr3 = allocateBlock(&memoryPool);
+
+    EXPECT_TRUE(ptr1 == &buffer[1]);
+    EXPECT_TRUE(ptr2 == &buffer[2]);
+    EXPECT_TRUE(ptr3 == NULL);
+}
+
+TEST(MemoryPool, BatchMixedSources)
+{
+    uint64_t buffer[4];
+
+    MemoryPool memoryPool;
+    initializeMemoryPool(&memoryPool, buffer, 4, sizeof(buffer[0]));
+
+    void *ptr1 = allocateBlock(&memoryPool);
+    void *ptr2 = allocateBlock(&memoryPool);
+    releaseBlock(&memoryPool, ptr1);
+
+    void *pointers[4];
+    size_t numberOfBlocks = allocateBlocks(&memoryPool, pointers, 4);
+
+    EXPECT_EQ(3u, numberOfBlocks);
+    EXPECT_TRUE(pointers[0] == ptr1);
+    EXPECT_TRUE(pointers[1] == &buffer[2]);
+    EXPECT_TRUE(pointers[2] == &buffer[3]);
+    EXPECT_TRUE(ptr2 == &buffer[1]);
+}
+
+TEST(MemoryPool, ReleaseBlockChain)
+{
+    uint64_t buffer[4];
+
+    MemoryPool memoryPool;
+    initializeMemoryPool(&memoryPool, buffer, 2, sizeof(buffer[0]));
+
+    buffer[2] = (uint64_t) (uintptr_t) &buffer[3];
+    releaseBlockChain(&memoryPool, &buffer[2], &buffer[3], 2);
+    releaseBlockChain(&memoryPool, NULL, NULL, 0);
+
+    void *ptr1 = allocateBlock(&memoryPool);
+    void *ptr2 = allocateBlock(&memoryPool);
+    void *ptr3 = allocateBlock(&memoryPool);
+    void *ptr4 = allocateBlock(&memoryPool);
+    void *ptr5 = allocateBlock(&memoryPool);
+
+    EXPECT_TRUE(ptr1 == &buffer[2]);
+    EXPECT_TRUE(ptr2 == &buffer[3]);
+    EXPECT_TRUE(ptr3 == &buffer[0]);
+    EXPECT_TRUE(ptr4 == &buffer[1]);
+    EXPECT_TRUE(ptr5 == NULL);
+}
+
+TEST(MemoryPool, MergeMemoryPools)
+{
+    uint64_t buffer1[4];
+    uint64_t buffer2[2];
+
+    MemoryPool memoryPool1;
+    MemoryPool memoryPool2;
+    initializeMemoryPool(&memoryPool1, buffer1, 4, sizeof(buffer1[0]));
+    initializeMemoryPool(&memoryPool2, buffer2, 2, sizeof(buffer2[0]));
+
+    void *ptr1 = allocateBlock(&memoryPool1);
+    void *ptr2 = allocateBlock(&memoryPool2);
+    releaseBlock(&memoryPool1, ptr1);
+    releaseBlock(&memoryPool2, ptr2);
+
+    EXPECT_TRUE(mergeMemoryPools(&memoryPool1, &memoryPool2));
+    EXPECT_TRUE(allocateBlock(&memoryPool2) == NULL);
+
+    unsigned numberOfBlocks = 0;
+    while(allocateBlock(&memoryPool1))
+        numberOfBlocks++;
+
+    EXPECT_EQ(6u, numberOfBlocks);
+}
+
+TEST(MemoryPool, MergeIntoEmptyMemoryPool)
+{
+    uint64_t buffer[4];
+
+    MemoryPool memoryPool1;
+    MemoryPool memoryPool2;
+    initializeMemoryPool(&memoryPool1, NULL, 0, sizeof(buffer[0]));
+    initializeMemoryPool(&memoryPool2, buffer, 4, sizeof(buffer[0]));
+
+    void *ptr1 = allocateBlock(&memoryPool2);
+    releaseBlock(&memoryPool2, ptr1);
+
+    EXPECT_TRUE(mergeMemoryPools(&memoryPool1, &memoryPool2));
+
+    EXPECT_TRUE(allocateBlock(&memoryPool1) == &buffer[0]);
+    EXPECT_TRUE(allocateBlock(&memoryPool1) == &buffer[1]);
+    EXPECT_TRUE(allocateBlock(&memoryPool1) == &buffer[2]);
+    EXPECT_TRUE(allocateBlock(&memoryPool1) == &buffer[3]);
+    EXPECT_TRUE(allocateBlock(&memoryPool1) == NULL);
+}
+
+TEST(MemoryPool, MergeFreeLists)
+{
+    uint64_t buffer1[2];
+    uint64_t buffer2[3];
+
+    MemoryPool memoryPool1;
+    MemoryPool memoryPool2;
+    initializeMemoryPool(&memoryPool1, buffer1, 2, sizeof(buffer1[0]));
+    initializeMemoryPool(&memoryPool2, buffer2, 3, sizeof(buffer2[0]));
+
+    for(unsigned i = 0; i < 2; i++)
+        allocateBlock(&memoryPool1);
+    for(unsigned i = 0; i < 3; i++)
+        allocateBlock(&memoryPool2);
+
+    releaseBlock(&memoryPool1, &buffer1[0]);
+    releaseBlock(&memoryPool1, &buffer1[1]);
+    releaseBlock(&memoryPool2, &buffer2[0]);
+    releaseBlock(&memoryPool2, &buffer2[2]);
+
+    EXPECT_TRUE(mergeMemoryPools(&memoryPool1, &memoryPool2));
+
+    EXPECT_TRUE(allocateBlock(&memoryPool1) == &buffer2[2]);
+    EXPECT_TRUE(allocateBlock(&memoryPool1) == &buffer2[0]);
+    EXPECT_TRUE(allocateBlock(&memoryPool1) == &buffer1[1]);
+    EXPECT_TRUE(allocateBlock(&memoryPool1) == &buffer1[0]);
+    EXPECT_TRUE(allocateBlock(&memoryPool1) == NULL);
+}
+
+TEST(MemoryPool, MergeMergedFreeLists)
+{
+    uint64_t buffer[3];
+
+    MemoryPool memoryPool1;
+    MemoryPool memoryPool2;
+    MemoryPool memoryPool3;
+    initializeMemoryPool(&memoryPool1, &buffer[0], 1, sizeof(buffer[0]));
+    initializeMemoryPool(&memoryPool2, &buffer[1], 1, sizeof(buffer[0]));
+    initializeMemoryPool(&memoryPool3, &buffer[2], 1, sizeof(buffer[0]));
+
+    releaseBlock(&memoryPool1, allocateBlock(&memoryPool1));
+    releaseBlock(&memoryPool2, allocateBlock(&memoryPool2));
+    releaseBlock(&memoryPool3, allocateBlock(&memoryPool3));
+
+    EXPECT_TRUE(mergeMemoryPools(&memoryPool1, &memoryPool2));
+    EXPECT_TRUE(mergeMemoryPools(&memoryPool3, &memoryPool1));
+
+    EXPECT_TRUE(allocateBlock(&memoryPool3) == &buffer[1]);
+    EXPECT_TRUE(allocateBlock(&memoryPool3) == &buffer[0]);
+    EXPECT_TRUE(allocateBlock(&memoryPool3) == &buffer[2]);
+    EXPECT_TRUE(allocateBlock(&memoryPool3) == NULL);
+}
+
+TEST(MemoryPool, MergeNotYetUsedBlocks)
+{
+    uint64_t buffer1[2];
+    uint64_t buffer2[4];
+    uint64_t buffer3[3];
+
+    MemoryPool memoryPool1;
+    MemoryPool memoryPool2;
+    MemoryPool memoryPool3;
+    initializeMemoryPool(&memoryPool1, buffer1, 2, sizeof(buffer1[0]));
+    initializeMemoryPool(&memoryPool2, buffer2, 4, sizeof(buffer2[0]));
+    initializeMemoryPool(&memoryPool3, buffer3, 3, sizeof(buffer3[0]));
+
+    EXPECT_TRUE(mergeMemoryPools(&memoryPool1, &memoryPool2));
+    EXPECT_TRUE(mergeMemoryPools(&memoryPool3, &memoryPool1));
+
+    // The longest run is used first, then the others in order of merging
+    for(unsigned i = 0; i < 4; i++)
+        EXPECT_TRUE(allocateBlock(&memoryPool3) == &buffer2[i]);
+
+    void *pointers[6];
+    EXPECT_EQ(5u, allocateBlocks(&memoryPool3, pointers, 6));
+    EXPECT_TRUE(pointers[0] == &buffer3[0]);
+    EXPECT_TRUE(pointers[2] == &buffer3[2]);
+    EXPECT_TRUE(pointers[3] == &buffer1[0]);
+    EXPECT_TRUE(pointers[4] == &buffer1[1]);
+    EXPECT_TRUE(allocateBlock(&memoryPool3) == NULL);
+}
+
+TEST(MemoryPool, MergeDifferentBlockSizes)
+{
+    uint64_t buffer[4];
+
+    MemoryPool memoryPool1;
+    MemoryPool memoryPool2;
+    initializeMemoryPool(&memoryPool1, buffer, 2, sizeof(buffer[0]));
+    initializeMemoryPool(&memoryPool2, buffer + 2, 1, 2 * sizeof(buffer[0]));
+
+    EXPECT_FALSE(mergeMemoryPools(&memoryPool1, &memoryPool2));
+    EXPECT_TRUE(allocateBlock(&memoryPool2) == &buffer[2]);
+}
+
+TEST(MemoryPool, AlignedBlockSize)
+{
+    EXPECT_EQ(MIN_MEMORY_POOL_BLOCK_SIZE, getAlignedBlockSize(1, 0));
+    EXPECT_EQ(MIN_MEMORY_POOL_BLOCK_SIZE, getAlignedBlockSize(1, 1));
+    EXPECT_EQ(23u, getAlignedBlockSize(23, 1));
+    EXPECT_EQ(32u, getAlignedBlockSize(23, 16));
+    EXPECT_EQ(64u, getAlignedBlockSize(64, 64));
+    EXPECT_EQ(128u, getAlignedBlockSize(65, 64));
+
+    EXPECT_EQ(3u * 32u + 15u, getAlignedMemoryRegionSize(3, 23, 16));
+    EXPECT_EQ(3u * 23u, getAlignedMemoryRegionSize(3, 23, 0));
+
+    EXPECT_EQ(3u, getNumberOfAlignedBlocks(3u * 32u + 15u, 23, 16));
+    EXPECT_EQ(3u, getNumberOfAlignedBlocks(4u * 32u, 23, 16));
+    EXPECT_EQ(3u, getNumberOfAlignedBlocks(3u * 23u + 22u, 23, 0));
+    EXPECT_EQ(0u, getNumberOfAlignedBlocks(7, 23, 16));
+}
+
+TEST(MemoryPool, AlignedAllocScheme)
+{
+    const size_t alignment = 64;
+    const size_t numberOfBlocks = 4;
+    uint8_t memoryRegion[numberOfBlocks * alignment + alignment];
+
+    MemoryPool memoryPool;
+    initializeAlignedMemoryPool(&memoryPool, memoryRegion + 1, numberOfBlocks, 40, alignment);
+
+    for(size_t i = 0; i < numberOfBlocks; i++) {
+        uint8_t *pointer = (uint8_t *) allocateBlock(&memoryPool);
+
+        ASSERT_TRUE(pointer != NULL);
+        EXPECT_EQ(0u, (uintptr_t) pointer % alignment);
+        EXPECT_TRUE(pointer > memoryRegion);
+        EXPECT_TRUE(pointer + alignment <= memoryRegion + sizeof(memoryRegion));
+    }
+
+    EXPECT_TRUE(allocateBlock(&memoryPool) == NULL);
+}
+
+TEST(MemoryPool, ExtendMemoryPool)
+{
+    uint64_t buffer1[2];
+    uint64_t buffer2[2];
+
+    MemoryPool memoryPool;
+    initializeMemoryPool(&memoryPool, buffer1, 2, sizeof(uint64_t));
+
+    void *ptr1 = allocateBlock(&memoryPool);
+    EXPECT_EQ(0, extendMemoryPool(&memoryPool, buffer2, 2));
+
+    void *ptr2 = allocateBlock(&memoryPool);
+    releaseBlock(&memoryPool, ptr1);
+    EXPECT_EQ(1, extendMemoryPool(&memoryPool, buffer2, 2));
+
+    EXPECT_TRUE(allocateBlock(&memoryPool) == ptr1);
+    EXPECT_TRUE(allocateBlock(&memoryPool) == &buffer2[0]);
+    EXPECT_TRUE(allocateBlock(&memoryPool) == &buffer2[1]);
+    EXPECT_TRUE(allocateBlock(&memoryPool) == NULL);
+    EXPECT_TRUE(ptr2 == &buffer1[1]);
+}
+
+#ifdef MEMORY_POOL_STATISTICS
+TEST(MemoryPool, Statistics)
+{
+    uint64_t buffer1[4];
+    uint64_t buffer2[4];
+    void *pointers[4];
+
+    MemoryPool memoryPool;
+    initializeMemoryPool(&memoryPool, buffer1, 4, sizeof(uint64_t));
+
+    void *ptr1 = allocateBlock(&memoryPool);
+    void *ptr2 = allocateBlock(&memoryPool);
+    releaseBlock(&memoryPool, ptr1);
+
+    EXPECT_EQ(3u, allocateBlocks(&memoryPool, pointers, 4));
+    EXPECT_TRUE(allocateBlock(&memoryPool) == NULL);
+    releaseBlocks(&memoryPool, pointers, 3);
+
+    EXPECT_EQ(5u, memoryPool.statistics.numberOfAllocations);
+    EXPECT_EQ(2u, memoryPool.statistics.numberOfFailedAllocations);
+    EXPECT_EQ(4u, memoryPool.statistics.numberOfReleases);
+    EXPECT_EQ(1u, memoryPool.statistics.numberOfLiveBlocks);
+    EXPECT_EQ(4u, memoryPool.statistics.maxNumberOfLiveBlocks);
+    EXPECT_EQ(1u, memoryPool.statistics.numberOfMemoryRegions);
+
+    MemoryPool otherMemoryPool;
+    initializeMemoryPool(&otherMemoryPool, buffer2, 4, sizeof(uint64_t));
+    allocateBlock(&otherMemoryPool);
+
+    EXPECT_EQ(1, mergeMemoryPools(&memoryPool, &otherMemoryPool));
+    EXPECT_EQ(6u, memoryPool.statistics.numberOfAllocations);
+    EXPECT_EQ(4u, memoryPool.statistics.numberOfReleases);
+    EXPECT_EQ(2u, memoryPool.statistics.numberOfLiveBlocks);
+    EXPECT_EQ(2u, memoryPool.statistics.numberOfMemoryRegions);
+    EXPECT_EQ(0u, otherMemoryPool.statistics.numberOfAllocations);
+
+    releaseBlock(&memoryPool, ptr2);
+    EXPECT_EQ(1u, memoryPool.statistics.numberOfLiveBlocks);
+}
+#endif
+
+TEST(MemoryPool, SortFreeList)
+{
+    const size_t numberOfBlocks = 1000;
+    static uint64_t memoryRegion[numberOfBlocks * 3];
+
+    MemoryPool memoryPool;
+    initializeMemoryPool(&memoryPool, memoryRegion, numberOfBlocks, 3 * sizeof(uint64_t));
+
+    void *blocks[numberOfBlocks];
+    for(size_t i = 0; i < numberOfBlocks; i++)
+        blocks[i] = allocateBlock(&memoryPool);
+
+    for(size_t i = 0; i < numberOfBlocks; i++)
+        releaseBlock(&memoryPool, blocks[(i * 7919) % numberOfBlocks]);
+
+    EXPECT_EQ(numberOfBlocks, sortFreeList(&memoryPool));
+
+    for(size_t i = 0; i < numberOfBlocks; i++)
+        EXPECT_TRUE(allocateBlock(&memoryPool) == blocks[i]);
+
+    EXPECT_TRUE(allocateBlock(&memoryPool) == NULL);
+
+    releaseBlock(&memoryPool, blocks[5]);
+    releaseBlock(&memoryPool, blocks[2]);
+    EXPECT_EQ(2u, sortFreeList(&memoryPool));
+
+    /* Release to the end of list has to follow the sorted blocks */
+    void *blocksToMerge[] = { blocks[9] };
+    MemoryPool otherMemoryPool;
+    initializeMemoryPool(&otherMemoryPool, NULL, 0, 3 * sizeof(uint64_t));
+    releaseBlocks(&otherMemoryPool, blocksToMerge, 1);
+    EXPECT_EQ(1, mergeMemoryPools(&otherMemoryPool, &memoryPool));
+
+    EXPECT_TRUE(allocateBlock(&otherMemoryPool) == blocks[2]);
+    EXPECT_TRUE(allocateBlock(&otherMemoryPool) == blocks[5]);
+    EXPECT_TRUE(allocateBlock(&otherMemoryPool) == blocks[9]);
+    EXPECT_TRUE(allocateBlock(&otherMemoryPool) == NULL);
+}
+
+TEST(MemoryPool, SortFreeListPrefix)
+{
+    uint64_t memoryRegion[8];
+
+    MemoryPool memoryPool;
+    initializeMemoryPool(&memoryPool, memoryRegion, 8, sizeof(uint64_t));
+
+    for(size_t i = 0; i < 8; i++)
+        allocateBlock(&memoryPool);
+
+    for(size_t i = 0; i < 8; i++)
+        releaseBlock(&memoryPool, &memoryRegion[i]);
+
+    EXPECT_EQ(0u, sortFreeListPrefix(&memoryPool, 1));
+    EXPECT_EQ(3u, sortFreeListPrefix(&memoryPool, 3));
+
+    EXPECT_TRUE(allocateBlock(&memoryPool) == &memoryRegion[5]);
+    EXPECT_TRUE(allocateBlock(&memoryPool) == &memoryRegion[6]);
+    EXPECT_TRUE(allocateBlock(&memoryPool) == &memoryRegion[7]);
+
+    for(size_t i = 5; i > 0; i--)
+        EXPECT_TRUE(allocateBlock(&memoryPool) == &memoryRegion[i - 1]);
+
+    EXPECT_TRUE(allocateBlock(&memoryPool) == NULL);
+}
+
+TEST(MemoryPool, ContiguousBlocks)
+{
+    uint64_t memoryRegion[8];
+
+    MemoryPool memoryPool;
+    initializeMemoryPool(&memoryPool, memoryRegion, 8, sizeof(uint64_t));
+
+    EXPECT_TRUE(allocateContiguousBlocks(&memoryPool, 0) == NULL);
+    EXPECT_TRUE(allocateContiguousBlocks(&memoryPool, 3) == &memoryRegion[0]);
+    EXPECT_TRUE(allocateBlock(&memoryPool) == &memoryRegion[3]);
+    EXPECT_TRUE(allocateContiguousBlocks(&memoryPool, 5) == NULL);
+    EXPECT_TRUE(allocateContiguousBlocks(&memoryPool, 2) == &memoryRegion[4]);
+
+    releaseNotYetUsedBlocks(&memoryPool);
+    EXPECT_EQ(0u, memoryPool.numberOfNotYetUsedBlocks);
+    EXPECT_TRUE(allocateContiguousBlocks(&memoryPool, 1) == NULL);
+
+    releaseBlock(&memoryPool, &memoryRegion[3]);
+    releaseNotYetUsedBlocks(&memoryPool);
+
+    EXPECT_TRUE(allocateBlock(&memoryPool) == &memoryRegion[3]);
+    EXPECT_TRUE(allocateBlock(&memoryPool) == &memoryRegion[6]);
+    EXPECT_TRUE(allocateBlock(&memoryPool) == &memoryRegion[7]);
+    EXPECT_TRUE(allocateBlock(&memoryPool) == NULL);
+}
@@ -0,0 +1,244 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <set>
+#include <type_traits>
+#include <vector>
+#include "MemoryPoolAllocator.h"
+#include "gtest.h"
+
+namespace
+{
+    struct Element
+    {
+        std::int64_t value;
+    };
+
+    struct alignas(64) AlignedElement
+    {
+        std::int64_t value;
+    };
+
+    typedef MemoryPoolAllocator<Element> ElementAllocator;
+
+    bool isAligned(const void *pointer, std::size_t alignment)
+    {
+        return reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0;
+    }
+}
+
+TEST(MemoryPoolAllocator, SingleBlocks)
+{
+    ElementAllocator allocator(4);
+
+    Element *first = allocator.allocate(1);
+    Element *second = allocator.allocate(1);
+    EXPECT_TRUE(first != second);
+
+    allocator.deallocate(first, 1);
+    EXPECT_TRUE(allocator.allocate(1) == first);
+
+    allocator.deallocate(first, 1);
+    allocator.deallocate(second, 1);
+}
+
+TEST(MemoryPoolAllocator, RebindDoesNotThrow)
+{
+    EXPECT_TRUE(std::is_nothrow_copy_constructible<ElementAllocator>::value);
+    EXPECT_TRUE((std::is_nothrow_constructible<ElementAllocator,
+        const MemoryPoolAllocator<AlignedElement> &>::value));
+
+    // Rebound copy shares the memory pool of the same block size
+    ElementAllocator allocator(4);
+    Element *element = allocator.allocate(1);
+    allocator.deallocate(element, 1);
+
+    MemoryPoolAllocator<std::int64_t> otherAllocator(allocator);
+    MemoryPoolAllocator<Element> reboundAllocator(otherAllocator);
+    EXPECT_TRUE(reboundAllocator == allocator);
+    EXPECT_TRUE(reboundAllocator.allocate(1) == element);
+
+    allocator.deallocate(element, 1);
+}
+
+TEST(MemoryPoolAllocator, ArraysAreReused)
+{
+    ElementAllocator allocator(64);
+
+    for(std::size_t n = 2; n <= ElementAllocator::maxNumberOfContiguousElements; n++) {
+        Element *array = allocator.allocate(n);
+        for(std::size_t i = 0; i < n; i++)
+            array[i].value = static_cast<std::int64_t>(i);
+
+        allocator.deallocate(array, n);
+        EXPECT_TRUE(allocator.allocate(n) == array);
+        allocator.deallocate(array, n);
+    }
+}
+
+TEST(MemoryPoolAllocator, DeallocateBySameNumberOfElements)
+{
+    ElementAllocator allocator(64);
+
+    Element *block = allocator.allocate(1);
+    Element *array = allocator.allocate(3);
+    Element *otherArray = allocator.allocate(5);
+
+    allocator.deallocate(array, 3);
+    allocator.deallocate(otherArray, 5);
+    allocator.deallocate(block, 1);
+
+    // Released arrays are kept apart from single blocks and from arrays of
+    // other number of elements
+    EXPECT_TRUE(allocator.allocate(1) == block);
+    EXPECT_TRUE(allocator.allocate(5) == otherArray);
+    EXPECT_TRUE(allocator.allocate(3) == array);
+
+    allocator.deallocate(block, 1);
+    allocator.deallocate(array, 3);
+    allocator.deallocate(otherArray, 5);
+}
+
+TEST(MemoryPoolAllocator, UpstreamArrays)
+{
+    const std::size_t n = ElementAllocator::maxNumberOfContiguousElements + 1;
+    MemoryPoolAllocator<AlignedElement> allocator(64);
+
+    std::set<AlignedElement *> arrays;
+    for(int i = 0; i < 8; i++) {
+        AlignedElement *array = allocator.allocate(n);
+        EXPECT_TRUE(isAligned(array, 64));
+
+        for(std::size_t j = 0; j < n; j++)
+            array[j].value = static_cast<std::int64_t>(j);
+
+        arrays.insert(array);
+    }
+
+    EXPECT_EQ(8u, arrays.size());
+
+    for(std::set<AlignedElement *>::iterator iterator = arrays.begin(); iterator != arrays.end(); ++iterator)
+        allocator.deallocate(*iterator, n);
+}
+
+TEST(MemoryPoolAllocator, GivenAlignment)
+{
+    MemoryPoolAllocator<Element, 64> allocator(64);
+    const std::size_t sizes[] = { 1, 1, 7, 100 };
+
+    for(std::size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        Element *array = allocator.allocate(sizes[i]);
+        EXPECT_TRUE(isAligned(array, 64));
+        allocator.deallocate(array, sizes[i]);
+    }
+}
+
+TEST(MemoryPoolAllocator, ArrayBiggerThanMemoryRegion)
+{
+    // Array which does not fit into single memory region goes upstream
+    ElementAllocator allocator(4);
+
+    Element *array = allocator.allocate(8);
+    for(int i = 0; i < 8; i++)
+        array[i].value = i;
+
+    Element *block = allocator.allocate(1);
+    EXPECT_TRUE(block < array || block >= array + 8);
+
+    allocator.deallocate(block, 1);
+    allocator.deallocate(array, 8);
+}
+
+TEST(MemoryPoolAllocator, Vector)
+{
+    ElementAllocator allocator(64);
+    std::vector<Element, ElementAllocator> vector(allocator);
+
+    for(int i = 0; i < 1000; i++) {
+        Element element = { i };
+        vector.push_back(element);
+    }
+
+    for(int i = 0; i < 1000; i++)
+        EXPECT_EQ(i, vector[i].value);
+
+    // Small vectors are carved from memory regions and reused
+    std::vector<Element, ElementAllocator> smallVector(allocator);
+    smallVector.reserve(16);
+    const Element *data = smallVector.data();
+    smallVector = std::vector<Element, ElementAllocator>(allocator);
+    smallVector.reserve(16);
+    EXPECT_TRUE(smallVector.data() == data);
+}
+
+TEST(MemoryPoolAllocator, Deque)
+{
+    ElementAllocator allocator(64);
+    std::deque<Element, ElementAllocator> deque(allocator);
+
+    for(int i = 0; i < 1000; i++) {
+        Element element = { i };
+        if(i % 2)
+            deque.push_back(element);
+        else
+            deque.push_front(element);
+    }
+
+    for(int i = 0; i < 500; i++) {
+        EXPECT_EQ(998 - 2 * i, deque[i].value);
+        EXPECT_EQ(2 * i + 1, deque[500 + i].value);
+    }
+}
+
+TEST(MemoryPoolAllocator, PooledSharedOutlivesAllocator)
+{
+    std::shared_ptr<Element> element;
+    std::weak_ptr<Element> weakElement;
+
+    {
+        ElementAllocator allocator(4);
+        element = allocatePooledShared<Element>(allocator);
+        element->value = 1;
+
+        std::shared_ptr<Element> otherElement = allocatePooledShared<Element>(allocator);
+        weakElement = otherElement;
+    }
+
+    // Memory pool is kept by control blocks of the objects
+    EXPECT_EQ(1, element->value);
+    EXPECT_TRUE(weakElement.expired());
+
+    element.reset();
+    weakElement.reset();
+}
@@ -0,0 +1,210 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifdef MEMORY_POOL_STATISTICS
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "StaticMemoryPool.h"
+#include "GrowingMemoryPool.h"
+#include "ThreadCachingMemoryPool.h"
+#include "MemoryPoolAllocator.h"
+#include "MemoryPoolStatistics.h"
+#include "gtest.h"
+
+namespace
+{
+    struct Element
+    {
+        std::int64_t value;
+    };
+
+    typedef GrowingMemoryPool<Element> ElementPool;
+}
+
+TEST(MemoryPoolStatistics, GrowthIsNotFailedAllocation)
+{
+    ElementPool memoryPool(4);
+    std::vector<Element *> elements;
+
+    for(int i = 0; i < 10; i++)
+        elements.push_back(memoryPool.allocateBlock());
+
+    MemoryPoolSnapshot snapshot = memoryPool.getStatistics();
+    EXPECT_EQ(10u, snapshot.statistics.numberOfAllocations);
+    EXPECT_EQ(0u, snapshot.statistics.numberOfFailedAllocations);
+    EXPECT_EQ(3u, snapshot.statistics.numberOfMemoryRegions);
+
+    for(std::size_t i = 0; i < elements.size(); i++)
+        memoryPool.releaseBlock(elements[i]);
+}
+
+TEST(MemoryPoolStatistics, ExhaustedStaticMemoryPool)
+{
+    Element memoryRegion[2];
+    StaticMemoryPool<Element> memoryPool(memoryRegion, 2);
+
+    Element *first = memoryPool.allocateBlock();
+    Element *second = memoryPool.allocateBlock();
+    EXPECT_TRUE(memoryPool.allocateBlock() == NULL);
+
+    MemoryPoolSnapshot snapshot = memoryPool.getStatistics();
+    EXPECT_EQ(2u, snapshot.statistics.numberOfAllocations);
+    EXPECT_EQ(1u, snapshot.statistics.numberOfFailedAllocations);
+    EXPECT_EQ(2u, snapshot.statistics.numberOfLiveBlocks);
+
+    memoryPool.releaseBlock(first);
+    memoryPool.releaseBlock(second);
+}
+
+TEST(MemoryPoolStatistics, ThreadCacheRefill)
+{
+    ThreadCachingMemoryPool<Element> memoryPool(4, 16);
+    std::vector<Element *> elements;
+
+    for(int i = 0; i < 20; i++)
+        elements.push_back(memoryPool.allocateBlock());
+
+    MemoryPoolSnapshot snapshot = memoryPool.getStatistics();
+    EXPECT_EQ(0u, snapshot.statistics.numberOfFailedAllocations);
+    EXPECT_GE(snapshot.statistics.numberOfAllocations, 20u);
+
+    for(std::size_t i = 0; i < elements.size(); i++)
+        memoryPool.releaseBlock(elements[i]);
+}
+
+TEST(MemoryPoolStatistics, AllocatorArrays)
+{
+    MemoryPoolAllocator<Element> allocator(16);
+
+    Element *first = allocator.allocate(3);
+    allocator.deallocate(first, 3);
+    Element *second = allocator.allocate(3);
+
+    MemoryPoolSnapshot snapshot = allocator.getStatistics();
+    EXPECT_EQ(6u, snapshot.statistics.numberOfAllocations);
+    EXPECT_EQ(3u, snapshot.statistics.numberOfReleases);
+    EXPECT_EQ(3u, snapshot.statistics.numberOfLiveBlocks);
+    EXPECT_EQ(3u, snapshot.statistics.maxNumberOfLiveBlocks);
+
+    allocator.deallocate(second, 3);
+    snapshot = allocator.getStatistics();
+    EXPECT_EQ(0u, snapshot.statistics.numberOfLiveBlocks);
+}
+
+TEST(MemoryPoolStatistics, RegisterAndUnregister)
+{
+    MemoryPoolStatisticsRegistry registry;
+    ElementPool first(4), second(8);
+
+    registry.registerMemoryPool("first", first);
+    registry.registerMemoryPool("second", second);
+    Element *element = second.allocateBlock();
+
+    std::vector<NamedMemoryPoolSnapshot> snapshots = registry.takeSnapshot();
+    ASSERT_EQ(2u, snapshots.size());
+    EXPECT_EQ("first", snapshots[0].name);
+    EXPECT_EQ(0u, snapshots[0].snapshot.statistics.numberOfLiveBlocks);
+    EXPECT_EQ("second", snapshots[1].name);
+    EXPECT_EQ(1u, snapshots[1].snapshot.statistics.numberOfLiveBlocks);
+
+    registry.unregisterMemoryPool(&first);
+    snapshots = registry.takeSnapshot();
+    ASSERT_EQ(1u, snapshots.size());
+    EXPECT_EQ("second", snapshots[0].name);
+
+    registry.unregisterMemoryPool(&second);
+    EXPECT_TRUE(registry.takeSnapshot().empty());
+    EXPECT_EQ("{\"memoryPools\":[]}", registry.exportJson());
+    EXPECT_EQ(std::string::npos, registry.exportPrometheus().find("{pool="));
+
+    second.releaseBlock(element);
+}
+
+TEST(MemoryPoolStatistics, ExportJson)
+{
+    MemoryPoolStatisticsRegistry registry;
+    ElementPool memoryPool(4);
+
+    registry.registerMemoryPool("nodes", memoryPool);
+    Element *first = memoryPool.allocateBlock();
+    Element *second = memoryPool.allocateBlock();
+    memoryPool.releaseBlock(first);
+
+    EXPECT_EQ("{\"memoryPools\":[{\"name\":\"nodes\",\"blockSize\":8,\"allocations\":2,"
+        "\"failedAllocations\":0,\"releases\":1,\"liveBlocks\":1,\"maxLiveBlocks\":2,"
+        "\"memoryRegions\":1}]}", registry.exportJson());
+
+    registry.unregisterMemoryPool(&memoryPool);
+    memoryPool.releaseBlock(second);
+}
+
+TEST(MemoryPoolStatistics, ExportPrometheus)
+{
+    MemoryPoolStatisticsRegistry registry;
+    ElementPool memoryPool(4);
+
+    registry.registerMemoryPool("nodes", memoryPool);
+    Element *element = memoryPool.allocateBlock();
+
+    std::string metrics = registry.exportPrometheus();
+    EXPECT_NE(std::string::npos, metrics.find(
+        "# TYPE fixmemalloc_allocations_total counter\n"
+        "fixmemalloc_allocations_total{pool=\"nodes\"} 1\n"));
+    EXPECT_NE(std::string::npos, metrics.find("fixmemalloc_block_size_bytes{pool=\"nodes\"} 8\n"));
+    EXPECT_NE(std::string::npos, metrics.find("fixmemalloc_failed_allocations_total{pool=\"nodes\"} 0\n"));
+    EXPECT_NE(std::string::npos, metrics.find("fixmemalloc_live_blocks{pool=\"nodes\"} 1\n"));
+    EXPECT_NE(std::string::npos, metrics.find("fixmemalloc_memory_regions{pool=\"nodes\"} 1\n"));
+
+    registry.unregisterMemoryPool(&memoryPool);
+    memoryPool.releaseBlock(element);
+}
+
+TEST(MemoryPoolStatistics, EscapedName)
+{
+    MemoryPoolStatisticsRegistry registry;
+    ElementPool memoryPool(4);
+
+    registry.registerMemoryPool("a\"b\\c\nd\te\x01" "f\x1f", memoryPool);
+
+    std::string json = registry.exportJson();
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"a\\\"b\\\\c\\nd\\te\\u0001f\\u001f\""));
+    for(std::size_t index = 0; index < json.size(); index++)
+        EXPECT_GE(static_cast<unsigned char>(json[index]), 0x20);
+
+    std::string metrics = registry.exportPrometheus();
+    EXPECT_NE(std::string::npos, metrics.find("{pool=\"a\\\"b\\\\c\\nd\te\x01" "f\x1f\"}"));
+
+    registry.unregisterMemoryPool(&memoryPool);
+}
+
+#endif
@@ -0,0 +1,117 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <thread>
+#include <vector>
+#include "OwnedMemoryPool.h"
+#include "gtest.h"
+
+TEST(OwnedMemoryPool, ReclaimOnMiss)
+{
+    void *memoryRegion[3];
+
+    OwnedMemoryPool memoryPool;
+    initializeOwnedMemoryPool(&memoryPool, memoryRegion, 3, sizeof(void *));
+
+    void *ptr1 = allocateOwnedBlock(&memoryPool);
+    void *ptr2 = allocateOwnedBlock(&memoryPool);
+    void *ptr3 = allocateOwnedBlock(&memoryPool);
+
+    releaseRemoteBlock(&memoryPool, ptr1);
+    releaseRemoteBlock(&memoryPool, ptr2);
+    EXPECT_TRUE(memoryPool.memoryPool.firstFreeBlock == NULL);
+
+    releaseOwnedBlock(&memoryPool, ptr3);
+    EXPECT_TRUE(allocateOwnedBlock(&memoryPool) == ptr3);
+    EXPECT_TRUE(memoryPool.firstRemoteFreeBlock == ptr2);
+
+    // Remote blocks are taken over only when the pool is empty
+    EXPECT_TRUE(allocateOwnedBlock(&memoryPool) == ptr2);
+    EXPECT_TRUE(memoryPool.firstRemoteFreeBlock == NULL);
+    EXPECT_TRUE(allocateOwnedBlock(&memoryPool) == ptr1);
+    EXPECT_TRUE(allocateOwnedBlock(&memoryPool) == NULL);
+}
+
+TEST(OwnedMemoryPool, ReclaimRemoteBlocks)
+{
+    void *memoryRegion[4];
+
+    OwnedMemoryPool memoryPool;
+    initializeOwnedMemoryPool(&memoryPool, memoryRegion, 4, sizeof(void *));
+
+    EXPECT_EQ(0u, reclaimRemoteBlocks(&memoryPool));
+
+    for(unsigned i = 0; i < 4; i++)
+        releaseRemoteBlock(&memoryPool, allocateOwnedBlock(&memoryPool));
+
+    EXPECT_EQ(4u, reclaimRemoteBlocks(&memoryPool));
+
+    for(unsigned i = 0; i < 4; i++)
+        EXPECT_TRUE(allocateOwnedBlock(&memoryPool) == &memoryRegion[3 - i]);
+    EXPECT_TRUE(allocateOwnedBlock(&memoryPool) == NULL);
+}
+
+TEST(OwnedMemoryPool, RemoteThreads)
+{
+    const unsigned numberOfThreads = 4;
+    const unsigned numberOfBlocks = 64 * 1024;
+
+    std::vector<uint64_t> buffer(numberOfBlocks);
+
+    OwnedMemoryPool memoryPool;
+    initializeOwnedMemoryPool(&memoryPool, &buffer[0], buffer.size(), sizeof(buffer[0]));
+
+    std::vector<uint64_t *> blocks;
+    for(unsigned i = 0; i < numberOfBlocks; i++)
+        blocks.push_back((uint64_t *) allocateOwnedBlock(&memoryPool));
+
+    // Owner keeps allocating while other threads release its blocks
+    std::vector<std::thread> threads;
+    for(unsigned threadIndex = 0; threadIndex < numberOfThreads; threadIndex++) {
+        threads.push_back(std::thread([&, threadIndex]() {
+            for(unsigned i = threadIndex; i < numberOfBlocks; i += numberOfThreads)
+                releaseRemoteBlock(&memoryPool, blocks[i]);
+        }));
+    }
+
+    unsigned numberOfReclaimedBlocks = 0;
+    while(numberOfReclaimedBlocks < numberOfBlocks) {
+        uint64_t *block = (uint64_t *) allocateOwnedBlock(&memoryPool);
+        if(block)
+            *block = numberOfReclaimedBlocks++;
+    }
+
+    for(unsigned threadIndex = 0; threadIndex < numberOfThreads; threadIndex++)
+        threads[threadIndex].join();
+
+    EXPECT_TRUE(allocateOwnedBlock(&memoryPool) == NULL);
+    EXPECT_TRUE(memoryPool.firstRemoteFreeBlock == NULL);
+}
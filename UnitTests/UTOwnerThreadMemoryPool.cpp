@@ -0,0 +1,165 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+#include "OwnerThreadMemoryPool.h"
+#include "gtest.h"
+
+namespace
+{
+    struct Element
+    {
+        std::int64_t value;
+
+        Element() :
+            value(-1)
+        {
+        }
+    };
+
+    struct alignas(32) AlignedElement
+    {
+        std::int64_t value;
+    };
+
+    typedef OwnerThreadMemoryPool<Element> ElementPool;
+    typedef std::set<Element *> ElementSet;
+}
+
+TEST(OwnerThreadMemoryPool, AllocateAndRelease)
+{
+    ElementPool memoryPool(4);
+    std::vector<Element *> elements;
+
+    for(int i = 0; i < 10; i++) {
+        elements.push_back(memoryPool.allocateBlock());
+        EXPECT_EQ(-1, elements.back()->value);
+    }
+
+    memoryPool.releaseBlock(elements[3]);
+    EXPECT_TRUE(memoryPool.allocateBlock() == elements[3]);
+}
+
+TEST(OwnerThreadMemoryPool, AlignedBlocks)
+{
+    OwnerThreadMemoryPool<AlignedElement> memoryPool(3);
+
+    for(int i = 0; i < 10; i++)
+        EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(memoryPool.allocateBlock()) % 32);
+}
+
+TEST(OwnerThreadMemoryPool, RemoteRelease)
+{
+    ElementPool memoryPool(8);
+    std::vector<Element *> elements;
+
+    for(int i = 0; i < 8; i++)
+        elements.push_back(memoryPool.allocateBlock());
+
+    std::thread([&]() {
+        for(std::size_t i = 0; i < elements.size(); i++)
+            memoryPool.releaseBlock(elements[i]);
+    }).join();
+
+    EXPECT_EQ(8u, memoryPool.reclaimRemoteBlocks());
+    EXPECT_EQ(0u, memoryPool.reclaimRemoteBlocks());
+
+    ElementSet releasedElements(elements.begin(), elements.end());
+    for(int i = 0; i < 8; i++)
+        EXPECT_TRUE(releasedElements.count(memoryPool.allocateBlock()) == 1);
+}
+
+TEST(OwnerThreadMemoryPool, ReclaimBeforeGrowing)
+{
+    ElementPool memoryPool(4);
+    std::vector<Element *> elements;
+
+    for(int i = 0; i < 4; i++)
+        elements.push_back(memoryPool.allocateBlock());
+
+    std::thread([&]() {
+        memoryPool.releaseBlock(elements[1]);
+        memoryPool.releaseBlock(elements[2]);
+    }).join();
+
+    // The memory pool ran out of blocks, so remote releases are reclaimed
+    Element *first = memoryPool.allocateBlock();
+    Element *second = memoryPool.allocateBlock();
+    EXPECT_TRUE((first == elements[1] && second == elements[2]) ||
+        (first == elements[2] && second == elements[1]));
+}
+
+TEST(OwnerThreadMemoryPool, MultipleThreads)
+{
+    const unsigned numberOfThreads = 4;
+    const unsigned numberOfElements = 16 * 1024;
+
+    ElementPool memoryPool(256);
+    std::vector<Element *> elements;
+
+    for(unsigned i = 0; i < numberOfElements; i++) {
+        elements.push_back(memoryPool.allocateBlock());
+        elements.back()->value = i;
+    }
+
+    std::vector<unsigned> failures(numberOfThreads);
+    std::vector<std::thread> threads;
+
+    for(unsigned threadIndex = 0; threadIndex < numberOfThreads; threadIndex++) {
+        threads.push_back(std::thread([&, threadIndex]() {
+            for(unsigned i = threadIndex; i < numberOfElements; i += numberOfThreads) {
+                if(elements[i]->value != static_cast<std::int64_t>(i))
+                    failures[threadIndex]++;
+
+                memoryPool.releaseBlock(elements[i]);
+            }
+        }));
+    }
+
+    // The owner keeps allocating while other threads release
+    std::vector<Element *> ownerElements;
+    for(unsigned i = 0; i < numberOfElements; i++)
+        ownerElements.push_back(memoryPool.allocateBlock());
+
+    for(unsigned threadIndex = 0; threadIndex < numberOfThreads; threadIndex++) {
+        threads[threadIndex].join();
+        EXPECT_EQ(0u, failures[threadIndex]);
+    }
+
+    ElementSet distinctElements(ownerElements.begin(), ownerElements.end());
+    EXPECT_EQ(ownerElements.size(), distinctElements.size());
+
+    for(std::size_t i = 0; i < ownerElements.size(); i++)
+        memoryPool.releaseBlock(ownerElements[i]);
+}
@@ -0,0 +1,183 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include "PersistentMemoryPool.h"
+#include "gtest.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+namespace
+{
+    struct Node
+    {
+        std::uint32_t next;
+        std::uint32_t value;
+    };
+
+    struct LargeNode
+    {
+        std::uint32_t next;
+        std::uint32_t values[15];
+    };
+
+    // Empty file, which the memory pool fills as new one
+    class TemporaryFile
+    {
+        public:
+
+            TemporaryFile()
+            {
+                std::snprintf(fileName, sizeof(fileName), "/tmp/UTPersistentMemoryPoolXXXXXX");
+                int fileDescriptor = ::mkstemp(fileName);
+                if(fileDescriptor >= 0)
+                    ::close(fileDescriptor);
+            }
+
+            ~TemporaryFile()
+            {
+                std::remove(fileName);
+            }
+
+            const char *getName() const
+            {
+                return fileName;
+            }
+
+
+        private:
+
+            char fileName[64];
+    };
+}
+
+TEST(PersistentMemoryPool, CreatesNewFile)
+{
+    TemporaryFile file;
+    PersistentMemoryPool<Node> memoryPool(file.getName(), 16);
+
+    EXPECT_FALSE(memoryPool.isRestored());
+    EXPECT_EQ(INDEXED_MEMORY_POOL_NULL_INDEX, memoryPool.getRootIndex());
+
+    for(std::uint32_t i = 0; i < 16; i++)
+        EXPECT_EQ(i, memoryPool.getIndex(memoryPool.allocateBlock()));
+
+    EXPECT_THROW(memoryPool.allocateBlock(), std::bad_alloc);
+}
+
+TEST(PersistentMemoryPool, ReopensWithStateAndRoot)
+{
+    TemporaryFile file;
+    std::uint32_t releasedIndex;
+
+    {
+        PersistentMemoryPool<Node> memoryPool(file.getName(), 16);
+        std::uint32_t head = INDEXED_MEMORY_POOL_NULL_INDEX;
+
+        for(std::uint32_t i = 0; i < 4; i++) {
+            Node *node = memoryPool.allocateBlock();
+            node->next = head;
+            node->value = i;
+            head = memoryPool.getIndex(node);
+        }
+
+        Node *released = memoryPool.allocateBlock();
+        releasedIndex = memoryPool.getIndex(released);
+        memoryPool.releaseBlock(released);
+
+        memoryPool.setRootIndex(head);
+        memoryPool.flush();
+    }
+
+    // Number of blocks is taken from the file
+    PersistentMemoryPool<Node> memoryPool(file.getName(), 1);
+    EXPECT_TRUE(memoryPool.isRestored());
+
+    std::uint32_t expectedValue = 4;
+    for(std::uint32_t index = memoryPool.getRootIndex(); index != INDEXED_MEMORY_POOL_NULL_INDEX;
+        index = memoryPool.getBlock(index)->next)
+        EXPECT_EQ(--expectedValue, memoryPool.getBlock(index)->value);
+    EXPECT_EQ(0u, expectedValue);
+
+    // Free list is restored as well
+    EXPECT_EQ(releasedIndex, memoryPool.getIndex(memoryPool.allocateBlock()));
+    for(int i = 0; i < 11; i++)
+        memoryPool.allocateBlock();
+    EXPECT_THROW(memoryPool.allocateBlock(), std::bad_alloc);
+}
+
+TEST(PersistentMemoryPool, RejectsIncompatibleBlockSize)
+{
+    TemporaryFile file;
+
+    {
+        PersistentMemoryPool<Node> memoryPool(file.getName(), 16);
+    }
+
+    EXPECT_THROW(PersistentMemoryPool<LargeNode>(file.getName(), 16), std::runtime_error);
+
+    // The file is left intact
+    PersistentMemoryPool<Node> memoryPool(file.getName(), 16);
+    EXPECT_TRUE(memoryPool.isRestored());
+}
+
+TEST(PersistentMemoryPool, RejectsIncompatibleSignature)
+{
+    TemporaryFile file;
+
+    {
+        PersistentMemoryPool<Node> memoryPool(file.getName(), 16);
+    }
+
+    std::FILE *stream = std::fopen(file.getName(), "r+b");
+    ASSERT_TRUE(stream != NULL);
+    std::fputs("Unknown", stream);
+    std::fclose(stream);
+
+    EXPECT_THROW(PersistentMemoryPool<Node>(file.getName(), 16), std::runtime_error);
+}
+
+TEST(PersistentMemoryPool, RejectsTooManyBlocks)
+{
+    TemporaryFile file;
+    std::uint64_t numberOfBlocks = static_cast<std::uint64_t>(INDEXED_MEMORY_POOL_NULL_INDEX) + 1;
+
+    if(numberOfBlocks > static_cast<std::size_t>(-1))
+        return;
+
+    EXPECT_THROW(PersistentMemoryPool<Node>(file.getName(), static_cast<std::size_t>(numberOfBlocks)),
+        std::length_error);
+}
+
+#endif
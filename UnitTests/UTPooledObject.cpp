@@ -0,0 +1,234 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <cstdint>
+#include <thread>
+#include "PooledObject.h"
+#include "gtest.h"
+
+namespace
+{
+    struct Element : public PooledObject<Element, 16>
+    {
+        std::int64_t value;
+
+        Element() :
+            value(-1)
+        {
+        }
+
+        virtual ~Element()
+        {
+        }
+    };
+
+    struct LargerElement : public Element
+    {
+        std::int64_t values[8];
+    };
+
+    struct alignas(64) AlignedElement : public PooledObject<AlignedElement, 16>
+    {
+        std::int64_t value;
+    };
+
+    struct ThreadLocalElement : public ThreadLocalPooledObject<ThreadLocalElement, 16>
+    {
+        std::int64_t value;
+
+        ThreadLocalElement() :
+            value(-1)
+        {
+        }
+
+        virtual ~ThreadLocalElement()
+        {
+        }
+    };
+
+    struct LargerThreadLocalElement : public ThreadLocalElement
+    {
+        std::int64_t values[8];
+    };
+
+    struct alignas(64) AlignedThreadLocalElement :
+        public ThreadLocalPooledObject<AlignedThreadLocalElement, 16>
+    {
+        std::int64_t value;
+    };
+
+    // Distinct types, so that memory pools are not shared with other tests
+    struct HandedOverElement : public ThreadLocalPooledObject<HandedOverElement, 16>
+    {
+        std::int64_t value;
+    };
+
+    struct LateDeletedElement : public ThreadLocalPooledObject<LateDeletedElement, 16>
+    {
+        std::int64_t value;
+    };
+
+    // Deletes the element after the memory pool of the thread is handed over
+    struct LateDeleter
+    {
+        LateDeletedElement *element;
+
+        ~LateDeleter()
+        {
+            delete element;
+        }
+    };
+
+    bool isAligned(const void *pointer, std::size_t alignment)
+    {
+        return reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0;
+    }
+
+    // Larger object does not take block from the memory pool, nor it is
+    // released to it by sized delete
+    template <class Base, class Larger>
+    void testLargerDerived()
+    {
+        Base *element = new Base;
+        delete element;
+
+        Base *larger = new Larger;
+        EXPECT_TRUE(larger != element);
+        delete larger;
+
+        Base *other = new Base;
+        EXPECT_TRUE(other == element);
+        EXPECT_EQ(-1, other->value);
+        delete other;
+    }
+
+    template <class Aligned>
+    void testAligned()
+    {
+        Aligned *elements[40];
+
+        for(int i = 0; i < 40; i++) {
+            elements[i] = new Aligned;
+            EXPECT_TRUE(isAligned(elements[i], 64));
+        }
+
+        for(int i = 0; i < 40; i++)
+            delete elements[i];
+    }
+}
+
+TEST(PooledObject, LargerDerivedGoesToGlobalOperators)
+{
+    testLargerDerived<Element, LargerElement>();
+}
+
+TEST(PooledObject, AlignedObjects)
+{
+    testAligned<AlignedElement>();
+}
+
+TEST(PooledObject, DeletedByOtherThread)
+{
+    Element *element = new Element;
+
+    std::thread([element]() {
+        delete element;
+    }).join();
+
+    Element *other = new Element;
+    EXPECT_TRUE(other == element);
+    delete other;
+}
+
+TEST(ThreadLocalPooledObject, LargerDerivedGoesToGlobalOperators)
+{
+    testLargerDerived<ThreadLocalElement, LargerThreadLocalElement>();
+}
+
+TEST(ThreadLocalPooledObject, AlignedObjects)
+{
+    testAligned<AlignedThreadLocalElement>();
+}
+
+TEST(ThreadLocalPooledObject, DeletedByOtherThread)
+{
+    ThreadLocalElement *element = new ThreadLocalElement;
+    bool isTakenOver = false;
+
+    // Block is taken over by memory pool of the deleting thread
+    std::thread([element, &isTakenOver]() {
+        delete element;
+
+        ThreadLocalElement *other = new ThreadLocalElement;
+        isTakenOver = other == element;
+        delete other;
+    }).join();
+
+    EXPECT_TRUE(isTakenOver);
+}
+
+TEST(ThreadLocalPooledObject, MemoryPoolHandedOverToNextThread)
+{
+    HandedOverElement *element = NULL;
+    HandedOverElement *other = NULL;
+
+    std::thread([&element]() {
+        element = new HandedOverElement;
+        delete element;
+    }).join();
+
+    std::thread([&other]() {
+        other = new HandedOverElement;
+        delete other;
+    }).join();
+
+    EXPECT_TRUE(other == element);
+}
+
+TEST(ThreadLocalPooledObject, DeletedAfterThreadExit)
+{
+    LateDeletedElement *element = NULL;
+
+    std::thread([&element]() {
+        thread_local LateDeleter lateDeleter = { NULL };
+        element = new LateDeletedElement;
+        lateDeleter.element = element;
+    }).join();
+
+    // Block released during thread exit is found by the next thread
+    LateDeletedElement *other = NULL;
+    std::thread([&other]() {
+        other = new LateDeletedElement;
+        delete other;
+    }).join();
+
+    EXPECT_TRUE(other == element);
+}
@@ -0,0 +1,171 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+#include "SharedMemoryPool.h"
+#include "gtest.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/wait.h>
+
+namespace
+{
+    const char *const name = "/UTSharedMemoryPool";
+
+    struct Message
+    {
+        std::uint32_t value;
+    };
+
+    struct LargeMessage
+    {
+        std::uint32_t values[16];
+    };
+
+    struct HugeMessage
+    {
+        std::uint8_t values[1 << 24];
+    };
+}
+
+TEST(SharedMemoryPool, ExchangesIndexBetweenProcesses)
+{
+    SharedMemoryPool<Message>::remove(name);
+    SharedMemoryPool<Message> memoryPool(name, 16);
+    EXPECT_TRUE(memoryPool.isCreated());
+
+    Message *message = memoryPool.allocateBlock();
+    message->value = 1;
+    std::uint32_t index = memoryPool.getIndex(message);
+
+    int pipeDescriptors[2];
+    ASSERT_EQ(0, ::pipe(pipeDescriptors));
+
+    pid_t processId = ::fork();
+    ASSERT_GE(processId, 0);
+
+    if(!processId) {
+        // Child opens the pool by name, reads the message and replies with
+        // index of its own one
+        int status = 1;
+        try {
+            SharedMemoryPool<Message> childMemoryPool(name, 0);
+            Message *reply = childMemoryPool.allocateBlock();
+
+            if(!childMemoryPool.isCreated() && childMemoryPool.getBlock(index)->value == 1 && reply) {
+                reply->value = 2;
+                std::uint32_t replyIndex = childMemoryPool.getIndex(reply);
+                if(::write(pipeDescriptors[1], &replyIndex, sizeof(replyIndex)) == sizeof(replyIndex))
+                    status = 0;
+            }
+        } catch(...) {
+        }
+
+        ::_exit(status);
+    }
+
+    std::uint32_t replyIndex = INDEXED_MEMORY_POOL_NULL_INDEX;
+    EXPECT_EQ(static_cast<ssize_t>(sizeof(replyIndex)), ::read(pipeDescriptors[0], &replyIndex, sizeof(replyIndex)));
+    ::close(pipeDescriptors[0]);
+    ::close(pipeDescriptors[1]);
+
+    int status;
+    ASSERT_EQ(processId, ::waitpid(processId, &status, 0));
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    EXPECT_NE(index, replyIndex);
+    EXPECT_EQ(2u, memoryPool.getBlock(replyIndex)->value);
+
+    memoryPool.releaseBlock(memoryPool.getBlock(replyIndex));
+    memoryPool.releaseBlock(message);
+    EXPECT_TRUE(SharedMemoryPool<Message>::remove(name));
+}
+
+TEST(SharedMemoryPool, RejectsIncompatibleBlockSize)
+{
+    SharedMemoryPool<Message>::remove(name);
+    SharedMemoryPool<Message> memoryPool(name, 16);
+
+    EXPECT_THROW(SharedMemoryPool<LargeMessage>(name, 16), std::runtime_error);
+
+    EXPECT_TRUE(SharedMemoryPool<Message>::remove(name));
+}
+
+TEST(SharedMemoryPool, TimesOutWaitingForCreator)
+{
+    // Object left empty, as when the creating process has died
+    SharedMemoryPool<Message>::remove(name);
+    int fileDescriptor = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    ASSERT_GE(fileDescriptor, 0);
+
+    try {
+        SharedMemoryPool<Message> memoryPool(name, 16, std::chrono::milliseconds(10));
+        ADD_FAILURE();
+    } catch(const std::system_error &error) {
+        EXPECT_EQ(ETIMEDOUT, error.code().value());
+    }
+
+    ::close(fileDescriptor);
+    EXPECT_TRUE(SharedMemoryPool<Message>::remove(name));
+}
+
+TEST(SharedMemoryPool, RemovedWhenCreationFails)
+{
+    if(sizeof(std::size_t) < sizeof(std::uint64_t))
+        return;
+
+    // Too large to be mapped
+    SharedMemoryPool<HugeMessage>::remove(name);
+    EXPECT_THROW(SharedMemoryPool<HugeMessage>(name, INDEXED_MEMORY_POOL_NULL_INDEX), std::system_error);
+
+    EXPECT_FALSE(SharedMemoryPool<HugeMessage>::remove(name));
+}
+
+TEST(SharedMemoryPool, RejectsTooManyBlocks)
+{
+    std::uint64_t numberOfBlocks = static_cast<std::uint64_t>(INDEXED_MEMORY_POOL_NULL_INDEX) + 1;
+
+    if(numberOfBlocks > static_cast<std::size_t>(-1))
+        return;
+
+    SharedMemoryPool<Message>::remove(name);
+    EXPECT_THROW(SharedMemoryPool<Message>(name, static_cast<std::size_t>(numberOfBlocks)),
+        std::length_error);
+
+    EXPECT_FALSE(SharedMemoryPool<Message>::remove(name));
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "SizeClassAllocator.h"
+#include "gtest.h"
+
+TEST(SizeClassAllocator, SizeClassLookup)
+{
+    const size_t blockSizes[] = { 16, 32, 48, 128, 1024 };
+    MemoryPool memoryPools[5];
+
+    SizeClassAllocator allocator;
+    initializeSizeClassAllocator(&allocator, memoryPools, blockSizes, 5);
+
+    EXPECT_EQ(0u, getSizeClass(&allocator, 0));
+    EXPECT_EQ(0u, getSizeClass(&allocator, 1));
+    EXPECT_EQ(0u, getSizeClass(&allocator, 16));
+    EXPECT_EQ(1u, getSizeClass(&allocator, 17));
+    EXPECT_EQ(2u, getSizeClass(&allocator, 48));
+    EXPECT_EQ(3u, getSizeClass(&allocator, 49));
+    EXPECT_EQ(3u, getSizeClass(&allocator, 128));
+    EXPECT_EQ(4u, getSizeClass(&allocator, 129));
+    EXPECT_EQ(4u, getSizeClass(&allocator, 1024));
+    EXPECT_EQ(5u, getSizeClass(&allocator, 1025));
+    EXPECT_EQ(5u, getSizeClass(&allocator, SIZE_MAX));
+}
+
+TEST(SizeClassAllocator, SmallTable)
+{
+    const size_t blockSizes[] = { 64 };
+    MemoryPool memoryPools[1];
+
+    SizeClassAllocator allocator;
+    initializeSizeClassAllocator(&allocator, memoryPools, blockSizes, 1);
+
+    EXPECT_EQ(0u, getSizeClass(&allocator, 64));
+    EXPECT_EQ(1u, getSizeClass(&allocator, 65));
+    EXPECT_EQ(1u, getSizeClass(&allocator, MAX_SIZE_CLASS_BLOCK_SIZE));
+}
+
+TEST(SizeClassAllocator, RejectsInvalidTable)
+{
+    const size_t unsortedBlockSizes[] = { 16, 64, 32 };
+    const size_t tooSmallBlockSizes[] = { 1, 16 };
+    MemoryPool memoryPools[3];
+
+    SizeClassAllocator allocator;
+    EXPECT_EQ(0, initializeSizeClassAllocator(&allocator, memoryPools, unsortedBlockSizes, 3));
+    EXPECT_EQ(0u, getSizeClass(&allocator, 16));
+    EXPECT_TRUE(allocateSizeClassBlock(&allocator, 16) == NULL);
+
+    EXPECT_EQ(0, initializeSizeClassAllocator(&allocator, memoryPools, tooSmallBlockSizes, 2));
+    EXPECT_TRUE(allocateSizeClassBlock(&allocator, 1) == NULL);
+
+    EXPECT_EQ(1, initializeSizeClassAllocator(&allocator, memoryPools, unsortedBlockSizes, 2));
+}
+
+TEST(SizeClassAllocator, DefaultSizeClasses)
+{
+    MemoryPool memoryPools[64];
+
+    SizeClassAllocator allocator;
+    initializeSizeClassAllocator(&allocator, memoryPools,
+        defaultSizeClasses, numberOfDefaultSizeClasses);
+
+    for(size_t size = 1; size <= MAX_SIZE_CLASS_BLOCK_SIZE; size++) {
+        size_t sizeClass = getSizeClass(&allocator, size);
+
+        ASSERT_LT(sizeClass, numberOfDefaultSizeClasses);
+        EXPECT_GE(defaultSizeClasses[sizeClass], size);
+        if(sizeClass) {
+            EXPECT_LT(defaultSizeClasses[sizeClass - 1], size);
+        }
+    }
+}
+
+TEST(SizeClassAllocator, AllocScheme)
+{
+    const size_t blockSizes[] = { 16, 64 };
+    MemoryPool memoryPools[2];
+    uint8_t smallBlocks[2 * 16];
+    uint8_t largeBlocks[1 * 64];
+
+    SizeClassAllocator allocator;
+    initializeSizeClassAllocator(&allocator, memoryPools, blockSizes, 2);
+    initializeMemoryPool(&memoryPools[0], smallBlocks, 2, 16);
+    initializeMemoryPool(&memoryPools[1], largeBlocks, 1, 64);
+
+    void *ptr1 = allocateSizeClassBlock(&allocator, 10);
+    void *ptr2 = allocateSizeClassBlock(&allocator, 40);
+    void *ptr3 = allocateSizeClassBlock(&allocator, 40);
+    void *ptr4 = allocateSizeClassBlock(&allocator, 100);
+
+    EXPECT_TRUE(ptr1 == smallBlocks);
+    EXPECT_TRUE(ptr2 == largeBlocks);
+    EXPECT_TRUE(ptr3 == NULL);
+    EXPECT_TRUE(ptr4 == NULL);
+
+    releaseSizeClassBlock(&allocator, ptr2, 40);
+
+    void *ptr5 = allocateSizeClassBlock(&allocator, 64);
+
+    EXPECT_TRUE(ptr5 == largeBlocks);
+}
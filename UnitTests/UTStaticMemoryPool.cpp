@@ -0,0 +1,199 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include "StaticMemoryPool.h"
+#include "gtest.h"
+
+namespace
+{
+    struct Element
+    {
+        std::int64_t value;
+
+        Element() :
+            value(-1)
+        {
+        }
+
+        Element(std::int64_t value) :
+            value(value)
+        {
+            if(value < 0)
+                throw std::invalid_argument("value");
+        }
+    };
+
+    typedef StaticMemoryPool<Element> ElementPool;
+}
+
+TEST(StaticMemoryPool, AllocateBlockWhenExhausted)
+{
+    Element memoryRegion[2];
+    ElementPool memoryPool(memoryRegion, 2);
+
+    Element *element1 = memoryPool.allocateBlock();
+    Element *element2 = memoryPool.allocateBlock();
+
+    EXPECT_EQ(-1, element1->value);
+    EXPECT_EQ(-1, element2->value);
+    EXPECT_TRUE(memoryPool.allocateBlock() == NULL);
+    EXPECT_TRUE(memoryPool.construct(1) == NULL);
+    EXPECT_TRUE(memoryPool.allocateUninitialized() == NULL);
+
+    memoryPool.releaseBlock(element2);
+    EXPECT_EQ(element2, memoryPool.allocateBlock());
+}
+
+TEST(StaticMemoryPool, Construct)
+{
+    Element memoryRegion[2];
+    ElementPool memoryPool(memoryRegion, 2);
+
+    Element *element = memoryPool.construct(7);
+    EXPECT_EQ(7, element->value);
+
+    memoryPool.releaseBlock(element);
+}
+
+TEST(StaticMemoryPool, ConstructorThrows)
+{
+    Element memoryRegion[1];
+    ElementPool memoryPool(memoryRegion, 1);
+
+    EXPECT_THROW(memoryPool.construct(-1), std::invalid_argument);
+
+    // The block is given back to the memory pool
+    Element *element = memoryPool.construct(1);
+    EXPECT_EQ(&memoryRegion[0], element);
+}
+
+TEST(StaticMemoryPool, AllocateUninitialized)
+{
+    Element memoryRegion[1];
+    ElementPool memoryPool(memoryRegion, 1);
+
+    Element *element = memoryPool.allocateUninitialized();
+    EXPECT_EQ(&memoryRegion[0], element);
+    EXPECT_TRUE(memoryPool.allocateUninitialized() == NULL);
+
+    memoryPool.releaseUninitialized(element);
+    EXPECT_EQ(element, memoryPool.allocateUninitialized());
+}
+
+TEST(StaticMemoryPool, MoveConstructor)
+{
+    Element memoryRegion[2];
+    ElementPool source(memoryRegion, 2);
+    Element *element1 = source.construct(1);
+
+    ElementPool destination(std::move(source));
+
+    // Moved from memory pool is empty, but usable
+    EXPECT_TRUE(source.allocateBlock() == NULL);
+
+    Element *element2 = destination.construct(2);
+    EXPECT_EQ(&memoryRegion[1], element2);
+    EXPECT_TRUE(destination.allocateBlock() == NULL);
+
+    destination.releaseBlock(element1);
+    destination.releaseBlock(element2);
+}
+
+TEST(StaticMemoryPool, MoveAssignment)
+{
+    Element sourceRegion[1];
+    Element destinationRegion[1];
+    ElementPool source(sourceRegion, 1);
+    ElementPool destination(destinationRegion, 1);
+
+    destination = std::move(source);
+    EXPECT_EQ(&sourceRegion[0], destination.allocateBlock());
+    EXPECT_TRUE(source.allocateBlock() == NULL);
+
+    ElementPool &self = destination;
+    destination = std::move(self);
+    EXPECT_TRUE(destination.allocateBlock() == NULL);
+}
+
+TEST(StaticMemoryPool, SmallBlocksStayInMemoryRegion)
+{
+    // Blocks smaller than a pointer are padded, so only half of them fit
+    struct
+    {
+        std::uint32_t memoryRegion[4];
+        std::uint32_t canary;
+    } buffer;
+    buffer.canary = 0xDEADBEEF;
+
+    StaticMemoryPool<std::uint32_t> memoryPool(buffer.memoryRegion, 4);
+    unsigned numberOfBlocks = 0;
+
+    while(std::uint32_t *block = memoryPool.allocateBlock()) {
+        EXPECT_TRUE(block + 1 <= buffer.memoryRegion + 4);
+        *block = 0;
+        numberOfBlocks++;
+    }
+
+    EXPECT_EQ(4 * sizeof(std::uint32_t) / sizeof(void *), numberOfBlocks);
+    EXPECT_EQ(0xDEADBEEFu, buffer.canary);
+}
+
+TEST(StaticMemoryPool, OverAlignedBlocksStayInMemoryRegion)
+{
+    struct alignas(64) Buffer
+    {
+        std::uint8_t padding[8];
+        std::int64_t memoryRegion[2];
+        std::int64_t canary;
+    } buffer;
+    buffer.canary = 0x5EED;
+
+    // The memory region is not aligned to 64 bytes and too small for a block
+    StaticMemoryPool<std::int64_t, 64> memoryPool(buffer.memoryRegion, 2);
+    EXPECT_TRUE(memoryPool.allocateBlock() == NULL);
+    EXPECT_EQ(0x5EED, buffer.canary);
+
+    // The aligned one holds blocks of 64 bytes only
+    alignas(64) std::int64_t memoryRegion[17];
+    memoryRegion[16] = 0x5EED;
+
+    StaticMemoryPool<std::int64_t, 64> otherMemoryPool(memoryRegion, 16);
+    std::int64_t *block1 = otherMemoryPool.allocateBlock();
+    std::int64_t *block2 = otherMemoryPool.allocateBlock();
+
+    EXPECT_TRUE(block1 == &memoryRegion[0]);
+    EXPECT_TRUE(block2 == &memoryRegion[8]);
+    EXPECT_TRUE(otherMemoryPool.allocateBlock() == NULL);
+    EXPECT_EQ(0x5EED, memoryRegion[16]);
+}
@@ -0,0 +1,223 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include <cstdint>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include "ThreadCachingMemoryPool.h"
+#include "gtest.h"
+
+namespace
+{
+    struct Element
+    {
+        std::int64_t value;
+
+        Element() :
+            value(-1)
+        {
+        }
+    };
+
+    struct alignas(32) AlignedElement
+    {
+        std::int64_t value;
+    };
+
+    typedef ThreadCachingMemoryPool<Element> ElementPool;
+    typedef std::set<Element *> ElementSet;
+}
+
+TEST(ThreadCachingMemoryPool, AllocateAndRelease)
+{
+    ElementPool memoryPool(16, 8);
+
+    Element *element = memoryPool.allocateBlock();
+    EXPECT_EQ(-1, element->value);
+    memoryPool.releaseBlock(element);
+
+    // Thread cache is a stack, so the block released last is allocated first
+    EXPECT_TRUE(memoryPool.allocateBlock() == element);
+}
+
+TEST(ThreadCachingMemoryPool, AlignedBlocks)
+{
+    ThreadCachingMemoryPool<AlignedElement> memoryPool(3, 4);
+
+    EXPECT_EQ(32u, ThreadCachingMemoryPool<AlignedElement>::FixedPool::alignedBlockSize);
+
+    for(int i = 0; i < 10; i++)
+        EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(memoryPool.allocateBlock()) % 32);
+}
+
+TEST(ThreadCachingMemoryPool, RefillAndFlush)
+{
+    ElementPool memoryPool(64, 8);
+    ElementSet flushedElements;
+
+    std::thread([&]() {
+        std::vector<Element *> elements;
+        for(int i = 0; i < 32; i++)
+            elements.push_back(memoryPool.allocateBlock());
+
+        // Blocks over the limit of cached blocks go back to the shared pool
+        for(std::size_t i = 0; i < elements.size(); i++) {
+            memoryPool.releaseBlock(elements[i]);
+            flushedElements.insert(elements[i]);
+        }
+    }).join();
+
+    // The exited thread returned everything, so another thread refills its
+    // cache only with blocks used before
+    std::thread([&]() {
+        for(int i = 0; i < 32; i++)
+            EXPECT_TRUE(flushedElements.count(memoryPool.allocateBlock()) == 1);
+    }).join();
+}
+
+TEST(ThreadCachingMemoryPool, CrossThreadRelease)
+{
+    const int numberOfElements = 100;
+    ElementPool memoryPool(16, 8);
+    std::vector<Element *> elements;
+
+    for(int i = 0; i < numberOfElements; i++) {
+        elements.push_back(memoryPool.allocateBlock());
+        elements.back()->value = i;
+    }
+
+    std::thread([&]() {
+        for(int i = 0; i < numberOfElements; i++) {
+            EXPECT_EQ(i, elements[i]->value);
+            memoryPool.releaseBlock(elements[i]);
+        }
+    }).join();
+
+    ElementSet releasedElements(elements.begin(), elements.end());
+    ElementSet allocatedElements;
+
+    // Blocks cached by this thread before are allocated first, the rest comes
+    // from the releasing thread
+    for(int i = 0; i < numberOfElements; i++)
+        allocatedElements.insert(memoryPool.allocateBlock());
+
+    EXPECT_EQ(static_cast<std::size_t>(numberOfElements), allocatedElements.size());
+
+    std::size_t numberOfReusedElements = 0;
+    for(ElementSet::iterator iterator = allocatedElements.begin(); iterator != allocatedElements.end(); ++iterator)
+        numberOfReusedElements += releasedElements.count(*iterator);
+    EXPECT_GE(numberOfReusedElements, static_cast<std::size_t>(numberOfElements - 8));
+}
+
+TEST(ThreadCachingMemoryPool, MultipleThreads)
+{
+    const unsigned numberOfThreads = 8;
+    const unsigned blocksPerThread = 64;
+    const unsigned numberOfIterations = 4 * 1024;
+
+    ElementPool memoryPool(64, 32);
+    std::vector<unsigned> failures(numberOfThreads);
+    std::vector<std::thread> threads;
+
+    for(unsigned threadIndex = 0; threadIndex < numberOfThreads; threadIndex++) {
+        threads.push_back(std::thread([&, threadIndex]() {
+            Element *blocks[blocksPerThread];
+
+            for(unsigned iteration = 0; iteration < numberOfIterations; iteration++) {
+                unsigned count = 1 + iteration % blocksPerThread;
+
+                for(unsigned i = 0; i < count; i++) {
+                    blocks[i] = memoryPool.allocateBlock();
+                    blocks[i]->value = threadIndex;
+                }
+
+                for(unsigned i = 0; i < count; i++) {
+                    if(blocks[i]->value != threadIndex)
+                        failures[threadIndex]++;
+
+                    memoryPool.releaseBlock(blocks[i]);
+                }
+            }
+        }));
+    }
+
+    for(unsigned threadIndex = 0; threadIndex < numberOfThreads; threadIndex++) {
+        threads[threadIndex].join();
+        EXPECT_EQ(0u, failures[threadIndex]);
+    }
+}
+
+TEST(ThreadCachingMemoryPool, DestroyedWhileThreadsHoldCaches)
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    int step = 0;
+
+    ElementPool *memoryPool = new ElementPool(16, 8);
+
+    std::thread thread([&]() {
+        memoryPool->releaseBlock(memoryPool->allocateBlock());
+
+        std::unique_lock<std::mutex> lock(mutex);
+        step = 1;
+        condition.notify_all();
+        condition.wait(lock, [&]() { return step == 2; });
+        lock.unlock();
+
+        // Memory pool created in place of destroyed one may get the same
+        // identifier, but not the cache left by the destroyed one
+        Element *element = memoryPool->allocateBlock();
+        EXPECT_EQ(-1, element->value);
+        memoryPool->releaseBlock(element);
+    });
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&]() { return step == 1; });
+
+        delete memoryPool;
+        memoryPool = new ElementPool(16, 8);
+
+        step = 2;
+        condition.notify_all();
+    }
+
+    thread.join();
+
+    Element *element = memoryPool->allocateBlock();
+    EXPECT_EQ(-1, element->value);
+    memoryPool->releaseBlock(element);
+
+    delete memoryPool;
+}
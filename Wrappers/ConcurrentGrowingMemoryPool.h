@@ -0,0 +1,154 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef ConcurrentGrowingMemoryPoolH
+#define ConcurrentGrowingMemoryPoolH
+
+#include <new>
+#include <cstdint>
+#include "ConcurrentMemoryPool.h"
+#include "FixedMemoryPool.h"
+#include "MemoryRegion.h"
+
+template <class DataType, std::size_t Alignment = alignof(DataType)>
+class ConcurrentGrowingMemoryPool : protected ConcurrentMemoryPool
+{
+    public:
+
+        // Block size and memory region size are computed the same way as for
+        // GrowingMemoryPool
+        typedef FixedMemoryPool<sizeof(DataType), Alignment> FixedPool;
+
+        ConcurrentGrowingMemoryPool(std::size_t growByNumberOfBlocks,
+            MemoryRegionType memoryRegionType = DefaultMemoryRegion) :
+            growByNumberOfBlocks(growByNumberOfBlocks),
+            memoryRegionType(memoryRegionType),
+            firstMemoryRegion(NULL)
+        {
+            ::inlinedInitializeConcurrentMemoryPool(this, NULL, 0, FixedPool::alignedBlockSize);
+        }
+
+        ~ConcurrentGrowingMemoryPool()
+        {
+            while(firstMemoryRegion) {
+                MemoryRegion *memoryRegion = firstMemoryRegion;
+                firstMemoryRegion = memoryRegion->nextMemoryRegion;
+
+                ::releaseMemoryRegion(memoryRegion->buffer, memoryRegion->size, memoryRegionType);
+                delete memoryRegion;
+            }
+        }
+
+        DataType *allocateBlock()
+        {
+            void *pointer = ::inlinedAllocateBlockConcurrent(this);
+
+            while(!pointer) {
+                allocateNewMemoryRegion();
+                pointer = ::inlinedAllocateBlockConcurrent(this);
+            }
+
+            DataType *data = static_cast<DataType *>(pointer);
+            new (data) DataType;
+
+            return data;
+        }
+
+        void releaseBlock(DataType *pointer)
+        {
+            pointer->~DataType();
+            ::inlinedReleaseBlockConcurrent(this, pointer);
+        }
+
+        // Returns all blocks to the memory pool by single compare-and-swap
+        void releaseBlocks(DataType **pointers, std::size_t numberOfBlocks)
+        {
+            for(std::size_t i = 0; i < numberOfBlocks; i++)
+                pointers[i]->~DataType();
+
+            ::inlinedReleaseBlocksConcurrent(this, reinterpret_cast<void **>(pointers), numberOfBlocks);
+        }
+
+
+    private:
+
+        struct MemoryRegion
+        {
+            MemoryRegion *nextMemoryRegion;
+            void *buffer;
+            std::size_t size;
+            std::size_t numberOfBlocks;
+        };
+
+        std::size_t growByNumberOfBlocks;
+        MemoryRegionType memoryRegionType;
+        MemoryRegion *volatile firstMemoryRegion;
+
+        void allocateNewMemoryRegion()
+        {
+            MemoryRegion *memoryRegion = new MemoryRegion;
+            std::size_t size = FixedPool::getMemoryRegionSize(growByNumberOfBlocks);
+            void *buffer = ::allocateMemoryRegion(size, memoryRegionType);
+
+            if(!buffer) {
+                delete memoryRegion;
+                throw std::bad_alloc();
+            }
+
+            memoryRegion->buffer = buffer;
+            memoryRegion->size = size;
+            // Rounded up memory region may hold more blocks than requested
+            memoryRegion->numberOfBlocks = FixedPool::getNumberOfBlocks(size);
+
+            std::uintptr_t alignedBuffer = reinterpret_cast<std::uintptr_t>(buffer);
+            if(Alignment > 1)
+                alignedBuffer = (alignedBuffer + Alignment - 1) & ~(std::uintptr_t(Alignment) - 1);
+
+            // Other thread could have extended the pool in the meantime
+            if(!::inlinedExtendConcurrentMemoryPool(this, reinterpret_cast<void *>(alignedBuffer),
+                memoryRegion->numberOfBlocks)) {
+                ::releaseMemoryRegion(buffer, size, memoryRegionType);
+                delete memoryRegion;
+                return;
+            }
+
+            do {
+                memoryRegion->nextMemoryRegion = firstMemoryRegion;
+            } while(!::atomicCompareExchangePointer(
+                reinterpret_cast<void *volatile *>(&firstMemoryRegion),
+                memoryRegion->nextMemoryRegion, memoryRegion));
+        }
+
+        ConcurrentGrowingMemoryPool(const ConcurrentGrowingMemoryPool &concurrentGrowingMemoryPool);
+        ConcurrentGrowingMemoryPool & operator =(const ConcurrentGrowingMemoryPool &concurrentGrowingMemoryPool);
+};
+
+#endif
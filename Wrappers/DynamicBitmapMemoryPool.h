@@ -0,0 +1,136 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef DynamicBitmapMemoryPoolH
+#define DynamicBitmapMemoryPoolH
+
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+#include "BitmapMemoryPool.h"
+
+// Blocks are stored without padding, unless Alignment bigger than alignment of
+// DataType is given. The bitmap is placed so that the first block following it
+// is aligned.
+template <class DataType, std::size_t Alignment = alignof(DataType)>
+class DynamicBitmapMemoryPool : protected BitmapMemoryPool
+{
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+
+    public:
+
+        static constexpr std::size_t alignedBlockSize = Alignment > 1 ?
+            (sizeof(DataType) + Alignment - 1) & ~(Alignment - 1) : sizeof(DataType);
+
+        DynamicBitmapMemoryPool(std::size_t numberOfBlocks)
+        {
+            memoryRegion = allocateMemoryForElements(numberOfBlocks);
+
+            ::inlinedInitializeBitmapMemoryPool(this, getAlignedMemoryRegion(numberOfBlocks),
+                numberOfBlocks, alignedBlockSize);
+        }
+
+        ~DynamicBitmapMemoryPool()
+        {
+            if(memoryRegion)
+                free(memoryRegion);
+        }
+
+        DataType *allocateBlock()
+        {
+            void *pointer = ::inlinedAllocateBitmapBlock(this);
+            if(!pointer)
+                return NULL;
+
+            DataType *data = static_cast<DataType *>(pointer);
+            new (data) DataType;
+
+            return data;
+        }
+
+        void releaseBlock(DataType *pointer)
+        {
+            pointer->~DataType();
+            ::inlinedReleaseBitmapBlock(this, pointer);
+        }
+
+        bool isAllocated(const DataType *pointer) const
+        {
+            return ::inlinedIsBitmapBlockAllocated(this, pointer) != 0;
+        }
+
+        std::size_t getNumberOfFreeBlocks() const
+        {
+            return numberOfFreeBlocks;
+        }
+
+
+    private:
+
+        void *memoryRegion;
+
+        DynamicBitmapMemoryPool(const DynamicBitmapMemoryPool &dynamicBitmapMemoryPool);
+        DynamicBitmapMemoryPool & operator =(const DynamicBitmapMemoryPool &dynamicBitmapMemoryPool);
+
+        static std::size_t getAlignmentPadding()
+        {
+            return Alignment > sizeof(std::size_t) ? Alignment - 1 : 0;
+        }
+
+        void *allocateMemoryForElements(std::size_t numberOfBlocks)
+        {
+            if(!numberOfBlocks)
+                return NULL;
+
+            return malloc(::inlinedGetBitmapMemoryRegionSize(numberOfBlocks, alignedBlockSize) +
+                getAlignmentPadding());
+        }
+
+        // Bitmap words keep it aligned to size_t, as the memory pool requires
+        void *getAlignedMemoryRegion(std::size_t numberOfBlocks) const
+        {
+            if(!memoryRegion)
+                return NULL;
+
+            std::uintptr_t bitmapSize = ::inlinedGetNumberOfBitmapWords(numberOfBlocks) * sizeof(std::size_t);
+            std::uintptr_t blocks = reinterpret_cast<std::uintptr_t>(memoryRegion) + bitmapSize;
+
+            if(getAlignmentPadding())
+                blocks = (blocks + Alignment - 1) & ~(static_cast<std::uintptr_t>(Alignment) - 1);
+
+            return reinterpret_cast<void *>(blocks - bitmapSize);
+        }
+};
+
+template <class DataType, std::size_t Alignment>
+constexpr std::size_t DynamicBitmapMemoryPool<DataType, Alignment>::alignedBlockSize;
+
+#endif
@@ -0,0 +1,116 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef DynamicHandleMemoryPoolH
+#define DynamicHandleMemoryPoolH
+
+#include <new>
+#include <cstdint>
+#include <cstdlib>
+#include "HandleMemoryPool.h"
+
+// Memory pool of fixed number of blocks referred by 32-bit handles instead of
+// pointers. Handle of released block is detected as stale.
+template <class DataType>
+class DynamicHandleMemoryPool : protected HandleMemoryPool
+{
+    public:
+
+        typedef std::uint32_t Handle;
+
+        static constexpr Handle nullHandle = HANDLE_MEMORY_POOL_NULL_HANDLE;
+
+        DynamicHandleMemoryPool(std::size_t numberOfBlocks)
+        {
+            memoryRegion = allocateMemoryForElements(numberOfBlocks);
+            if(numberOfBlocks && !memoryRegion)
+                throw std::bad_alloc();
+
+            ::inlinedInitializeHandleMemoryPool(this, memoryRegion, numberOfBlocks, sizeof(DataType));
+        }
+
+        ~DynamicHandleMemoryPool()
+        {
+            if(memoryRegion)
+                free(memoryRegion);
+        }
+
+        // Returns nullHandle when all blocks are in use
+        Handle allocateBlock()
+        {
+            Handle handle = ::inlinedAllocateHandleBlock(this);
+
+            if(handle != nullHandle)
+                new (::inlinedResolveHandle(this, handle)) DataType;
+
+            return handle;
+        }
+
+        // Returns false when the handle is stale
+        bool releaseBlock(Handle handle)
+        {
+            DataType *data = resolve(handle);
+            if(!data)
+                return false;
+
+            data->~DataType();
+            ::inlinedReleaseHandleBlock(this, handle);
+
+            return true;
+        }
+
+        // Returns NULL when the handle is stale
+        DataType *resolve(Handle handle) const
+        {
+            return static_cast<DataType *>(::inlinedResolveHandle(this, handle));
+        }
+
+
+    private:
+
+        void *memoryRegion;
+
+        DynamicHandleMemoryPool(const DynamicHandleMemoryPool &dynamicHandleMemoryPool);
+        DynamicHandleMemoryPool & operator =(const DynamicHandleMemoryPool &dynamicHandleMemoryPool);
+
+        void *allocateMemoryForElements(std::size_t numberOfBlocks)
+        {
+            if(!numberOfBlocks)
+                return NULL;
+
+            return malloc(::inlinedGetHandleMemoryRegionSize(numberOfBlocks, sizeof(DataType)));
+        }
+};
+
+template <class DataType>
+constexpr typename DynamicHandleMemoryPool<DataType>::Handle DynamicHandleMemoryPool<DataType>::nullHandle;
+
+#endif
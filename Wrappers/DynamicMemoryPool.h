@@ -32,19 +32,30 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #ifndef DynamicMemoryPoolH
 #define DynamicMemoryPoolH
 
-#include "MemoryPool.h"
+#include <new>
+#include <cstdlib>
+#include <utility>
+#include "FixedMemoryPool.h"
 
-template <class DataType>
-class DynamicMemoryPool : protected MemoryPool
+template <class DataType, std::size_t Alignment = alignof(DataType)>
+class DynamicMemoryPool : protected FixedMemoryPool<sizeof(DataType), Alignment>
 {
     public:
 
+        typedef FixedMemoryPool<sizeof(DataType), Alignment> FixedPool;
+
         DynamicMemoryPool(std::size_t numberOfBlocks)
         {
-            void *pointer = allocateMemoryForElements(numberOfBlocks);
-            memoryRegion = static_cast<DataType *>(pointer);
+            memoryRegion = allocateMemoryForElements(numberOfBlocks);
+
+            FixedPool::initialize(memoryRegion, numberOfBlocks);
+        }
 
-            ::inlinedInitializeMemoryPool(this, memoryRegion, numberOfBlocks, sizeof(DataType));
+        DynamicMemoryPool(DynamicMemoryPool &&dynamicMemoryPool) :
+            FixedPool(std::move(dynamicMemoryPool)),
+            memoryRegion(dynamicMemoryPool.memoryRegion)
+        {
+            dynamicMemoryPool.memoryRegion = NULL;
         }
 
         ~DynamicMemoryPool()
@@ -53,26 +64,74 @@ class DynamicMemoryPool : protected MemoryPool
                 free(memoryRegion);
         }
 
+        DynamicMemoryPool & operator =(DynamicMemoryPool &&dynamicMemoryPool)
+        {
+            if(this != &dynamicMemoryPool) {
+                if(memoryRegion)
+                    free(memoryRegion);
+
+                FixedPool::operator =(std::move(dynamicMemoryPool));
+                memoryRegion = dynamicMemoryPool.memoryRegion;
+                dynamicMemoryPool.memoryRegion = NULL;
+            }
+
+            return *this;
+        }
+
+        // Returns NULL when all blocks are in use
         DataType *allocateBlock()
         {
-            void *pointer = ::inlinedAllocateBlock(this);
+            DataType *data = allocateUninitialized();
+            if(data)
+                new (data) DataType;
+
+            return data;
+        }
+
+        // Constructs the block from given arguments, instead of default
+        // construction followed by assignment
+        template <class... Args>
+        DataType *construct(Args &&... args)
+        {
+            DataType *data = allocateUninitialized();
+            if(!data)
+                return NULL;
 
-            DataType *data = static_cast<DataType *>(pointer);
-            new (data) DataType;
+            try {
+                new (data) DataType(std::forward<Args>(args)...);
+            } catch(...) {
+                FixedPool::releaseBlock(data);
+                throw;
+            }
 
             return data;
         }
 
+        // Block is not constructed, it must be released by releaseUninitialized
+        DataType *allocateUninitialized()
+        {
+            return static_cast<DataType *>(FixedPool::allocateBlock());
+        }
+
         void releaseBlock(DataType *pointer)
         {
             pointer->~DataType();
-            ::inlinedReleaseBlock(this, pointer);
+            FixedPool::releaseBlock(pointer);
         }
 
+        void releaseUninitialized(DataType *pointer)
+        {
+            FixedPool::releaseBlock(pointer);
+        }
+
+#ifdef MEMORY_POOL_STATISTICS
+        using FixedPool::getStatistics;
+#endif
+
 
     private:
 
-        DataType *memoryRegion;
+        void *memoryRegion;
 
         DynamicMemoryPool(const DynamicMemoryPool &dynamicMemoryPool);
         DynamicMemoryPool & operator =(const DynamicMemoryPool &dynamicMemoryPool);
@@ -82,11 +141,7 @@ class DynamicMemoryPool : protected MemoryPool
             if(!numberOfBlocks)
                 return NULL;
 
-            unsigned blockSize = sizeof(DataType);
-            if(blockSize < MIN_MEMORY_POOL_BLOCK_SIZE)
-                blockSize = MIN_MEMORY_POOL_BLOCK_SIZE;
-
-            return malloc(blockSize * numberOfBlocks);
+            return malloc(FixedPool::getMemoryRegionSize(numberOfBlocks));
         }
 };
 
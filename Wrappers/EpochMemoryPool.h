@@ -0,0 +1,214 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef EpochMemoryPoolH
+#define EpochMemoryPoolH
+
+#include <mutex>
+#include <vector>
+#include "EpochReclamation.h"
+#include "ConcurrentGrowingMemoryPool.h"
+
+// Concurrent growing memory pool for nodes of lock-free structures. Nodes
+// removed from a structure are retired, and returned to the memory pool in
+// batches once no reader can access them anymore.
+template <class DataType>
+class EpochMemoryPool : public ConcurrentGrowingMemoryPool<DataType>
+{
+    private:
+
+        struct ParticipantRecord : public EpochParticipant
+        {
+            bool isUsed;
+            std::vector<void *> retiredBlocksBuffer;
+        };
+
+    public:
+
+        // Registers calling thread in the memory pool. It must be destroyed
+        // by the same thread, before the memory pool is destroyed.
+        class Participant
+        {
+            public:
+
+                explicit Participant(EpochMemoryPool &memoryPool) :
+                    memoryPool(memoryPool),
+                    record(memoryPool.acquireRecord())
+                {
+                }
+
+                ~Participant()
+                {
+                    memoryPool.collectRetiredBlocks(record);
+                    memoryPool.releaseRecord(record);
+                }
+
+                // Block must be already removed from the structure
+                void retireBlock(DataType *pointer)
+                {
+                    if(!::inlinedRetireBlock(&memoryPool.epochDomain, record, pointer)) {
+                        memoryPool.collectRetiredBlocks(record);
+                        if(!::inlinedRetireBlock(&memoryPool.epochDomain, record, pointer)) {
+                            // Some reader holds the epoch back
+                            memoryPool.growRecord(record);
+                            ::inlinedRetireBlock(&memoryPool.epochDomain, record, pointer);
+                        }
+                    }
+
+                    if(record->numberOfRetiredBlocks >= memoryPool.collectThreshold)
+                        memoryPool.collectRetiredBlocks(record);
+                }
+
+
+            private:
+
+                friend class EpochMemoryPool;
+
+                EpochMemoryPool &memoryPool;
+                ParticipantRecord *record;
+
+                Participant(const Participant &participant);
+                Participant & operator =(const Participant &participant);
+        };
+
+        // Critical section, within which blocks read from the structure stay
+        // valid even if other thread retires them
+        class Guard
+        {
+            public:
+
+                explicit Guard(Participant &participant) :
+                    participant(participant)
+                {
+                    ::inlinedEnterEpoch(&participant.memoryPool.epochDomain, participant.record);
+                }
+
+                ~Guard()
+                {
+                    ::inlinedLeaveEpoch(participant.record);
+                }
+
+
+            private:
+
+                Participant &participant;
+
+                Guard(const Guard &guard);
+                Guard & operator =(const Guard &guard);
+        };
+
+        EpochMemoryPool(std::size_t growByNumberOfBlocks, std::size_t collectThreshold = 128) :
+            ConcurrentGrowingMemoryPool<DataType>(growByNumberOfBlocks),
+            collectThreshold(collectThreshold ? collectThreshold : 1)
+        {
+            ::inlinedInitializeEpochDomain(&epochDomain);
+        }
+
+        // Blocks still retired are destructed as no reader is left
+        ~EpochMemoryPool()
+        {
+            EpochParticipant *participant = epochDomain.firstParticipant;
+
+            while(participant) {
+                ParticipantRecord *record = static_cast<ParticipantRecord *>(participant);
+                participant = participant->nextParticipant;
+
+                for(std::size_t i = 0; i < record->numberOfRetiredBlocks; i++)
+                    static_cast<DataType *>(record->retiredBlocks[i])->~DataType();
+
+                delete record;
+            }
+        }
+
+
+    private:
+
+        const std::size_t collectThreshold;
+        EpochDomain epochDomain;
+        std::mutex mutex;
+
+        // Records of unregistered threads are reused, so number of records does
+        // not exceed the number of threads registered at the same time. Records
+        // and their retired blocks buffers are freed only in the destructor, as
+        // other threads may traverse the participants list at any time.
+        ParticipantRecord *acquireRecord()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            for(EpochParticipant *participant = epochDomain.firstParticipant; participant;
+                participant = participant->nextParticipant) {
+                ParticipantRecord *record = static_cast<ParticipantRecord *>(participant);
+                if(!record->isUsed) {
+                    record->isUsed = true;
+                    return record;
+                }
+            }
+
+            ParticipantRecord *record = new ParticipantRecord;
+            record->isUsed = true;
+            record->retiredBlocksBuffer.resize(2 * collectThreshold);
+            ::inlinedInitializeEpochParticipant(record, &record->retiredBlocksBuffer[0],
+                record->retiredBlocksBuffer.size());
+            ::inlinedAddEpochParticipant(&epochDomain, record);
+
+            return record;
+        }
+
+        void releaseRecord(ParticipantRecord *record)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            record->isUsed = false;
+        }
+
+        void growRecord(ParticipantRecord *record)
+        {
+            record->retiredBlocksBuffer.resize(2 * record->retiredBlocksBuffer.size());
+            record->retiredBlocks = &record->retiredBlocksBuffer[0];
+            record->maxNumberOfRetiredBlocks = record->retiredBlocksBuffer.size();
+        }
+
+        void collectRetiredBlocks(ParticipantRecord *record)
+        {
+            DataType *pointers[64];
+            std::size_t numberOfBlocks;
+
+            do {
+                numberOfBlocks = ::inlinedCollectRetiredBlocks(&epochDomain, record,
+                    reinterpret_cast<void **>(pointers), sizeof(pointers) / sizeof(pointers[0]));
+                this->releaseBlocks(pointers, numberOfBlocks);
+            } while(numberOfBlocks == sizeof(pointers) / sizeof(pointers[0]));
+        }
+
+        EpochMemoryPool(const EpochMemoryPool &epochMemoryPool);
+        EpochMemoryPool & operator =(const EpochMemoryPool &epochMemoryPool);
+};
+
+#endif
@@ -0,0 +1,158 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef FixedMemoryPoolH
+#define FixedMemoryPoolH
+
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include "MemoryPool.h"
+#include "MemoryPoolStatistics.h"
+
+// Memory pool of block size and alignment known at compile time, so the block
+// stride does not have to be loaded from memory on allocation. It remains
+// a MemoryPool, which can be passed to all C functions.
+template <std::size_t BlockSize, std::size_t Alignment = 0>
+class FixedMemoryPool : protected MemoryPool
+{
+    static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+
+    public:
+
+        // The same rounding as done by inlinedGetAlignedBlockSize
+        static constexpr std::size_t minimumBlockSize =
+            BlockSize < MIN_MEMORY_POOL_BLOCK_SIZE ? MIN_MEMORY_POOL_BLOCK_SIZE : BlockSize;
+        static constexpr std::size_t alignedBlockSize = Alignment > 1 ?
+            (minimumBlockSize + Alignment - 1) & ~(Alignment - 1) : minimumBlockSize;
+
+        static constexpr std::size_t getMemoryRegionSize(std::size_t numberOfBlocks)
+        {
+            return numberOfBlocks * alignedBlockSize + (Alignment > 1 ? Alignment - 1 : 0);
+        }
+
+        static constexpr std::size_t getNumberOfBlocks(std::size_t memoryRegionSize)
+        {
+            return memoryRegionSize < getMemoryRegionSize(0) ? 0 :
+                (memoryRegionSize - getMemoryRegionSize(0)) / alignedBlockSize;
+        }
+
+        FixedMemoryPool()
+        {
+            initialize(NULL, 0);
+        }
+
+        FixedMemoryPool(void *memoryRegion, std::size_t numberOfBlocks)
+        {
+            initialize(memoryRegion, numberOfBlocks);
+        }
+
+        // Blocks are taken over, the moved from memory pool is left empty
+        FixedMemoryPool(FixedMemoryPool &&fixedMemoryPool) :
+            MemoryPool(fixedMemoryPool)
+        {
+            fixedMemoryPool.initialize(NULL, 0);
+        }
+
+        FixedMemoryPool & operator =(FixedMemoryPool &&fixedMemoryPool)
+        {
+            if(this != &fixedMemoryPool) {
+                MemoryPool::operator =(fixedMemoryPool);
+                fixedMemoryPool.initialize(NULL, 0);
+            }
+
+            return *this;
+        }
+
+        void initialize(void *memoryRegion, std::size_t numberOfBlocks)
+        {
+            ::inlinedInitializeAlignedMemoryPool(this, memoryRegion, numberOfBlocks,
+                BlockSize, Alignment);
+        }
+
+        bool extend(void *memoryRegion, std::size_t numberOfBlocks)
+        {
+            return ::inlinedExtendAlignedMemoryPool(this, memoryRegion, numberOfBlocks, Alignment) != 0;
+        }
+
+        void *allocateBlock()
+        {
+            void *pointer = firstFreeBlock;
+
+            if(pointer) {
+                firstFreeBlock = *static_cast<void **>(pointer);
+            } else if(numberOfNotYetUsedBlocks || ::inlinedTakePendingRun(this)) {
+                pointer = notYetUsedBlocks;
+                notYetUsedBlocks = static_cast<std::uint8_t *>(pointer) + alignedBlockSize;
+                numberOfNotYetUsedBlocks--;
+            }
+
+#ifdef MEMORY_POOL_STATISTICS
+            ::inlinedCountAllocatedBlocks(this, pointer ? 1 : 0, 1);
+#endif
+
+            return pointer;
+        }
+
+        void releaseBlock(void *pointer)
+        {
+            ::inlinedReleaseBlock(this, pointer);
+        }
+
+        // Growing wrappers check it before allocation, so that a block missing
+        // until the next memory region is not counted as failed allocation
+        bool isExhausted() const
+        {
+            return !firstFreeBlock && !numberOfNotYetUsedBlocks && !firstPendingRun;
+        }
+
+#ifdef MEMORY_POOL_STATISTICS
+        MemoryPoolSnapshot getStatistics() const
+        {
+            MemoryPoolSnapshot snapshot = { blockSize, statistics };
+            return snapshot;
+        }
+#endif
+
+
+    private:
+
+        FixedMemoryPool(const FixedMemoryPool &fixedMemoryPool);
+        FixedMemoryPool & operator =(const FixedMemoryPool &fixedMemoryPool);
+};
+
+template <std::size_t BlockSize, std::size_t Alignment>
+constexpr std::size_t FixedMemoryPool<BlockSize, Alignment>::minimumBlockSize;
+
+template <std::size_t BlockSize, std::size_t Alignment>
+constexpr std::size_t FixedMemoryPool<BlockSize, Alignment>::alignedBlockSize;
+
+#endif
@@ -32,52 +32,141 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #ifndef GrowingMemoryPoolH
 #define GrowingMemoryPoolH
 
-#include "MemoryPool.h"
-
-template <class DataType>
-class GrowingMemoryPool : protected MemoryPool
+#include <new>
+#include <cstdlib>
+#include <utility>
+#include "FixedMemoryPool.h"
+#include "MemoryRegion.h"
+
+template <class DataType, std::size_t Alignment = alignof(DataType)>
+class GrowingMemoryPool : protected FixedMemoryPool<sizeof(DataType), Alignment>
 {
     public:
 
-        GrowingMemoryPool(std::size_t growByNumberOfBlocks) :
+        typedef FixedMemoryPool<sizeof(DataType), Alignment> FixedPool;
+
+        GrowingMemoryPool(std::size_t growByNumberOfBlocks,
+            MemoryRegionType memoryRegionType = DefaultMemoryRegion) :
             growByNumberOfBlocks(growByNumberOfBlocks),
-            firstMemoryRegion(NULL)
+            memoryRegionType(memoryRegionType),
+            firstMemoryRegion(NULL),
+            sortThreshold(0),
+            numberOfReleasesSinceSort(0)
         {
-            ::inlinedInitializeMemoryPool(this, NULL, 0, sizeof(DataType));
+        }
+
+        // Memory regions are taken over, the moved from memory pool is left
+        // empty and it grows again when used
+        GrowingMemoryPool(GrowingMemoryPool &&growingMemoryPool) :
+            FixedPool(std::move(growingMemoryPool)),
+            growByNumberOfBlocks(growingMemoryPool.growByNumberOfBlocks),
+            memoryRegionType(growingMemoryPool.memoryRegionType),
+            firstMemoryRegion(growingMemoryPool.firstMemoryRegion),
+            sortThreshold(growingMemoryPool.sortThreshold),
+            numberOfReleasesSinceSort(growingMemoryPool.numberOfReleasesSinceSort)
+        {
+            growingMemoryPool.firstMemoryRegion = NULL;
+            growingMemoryPool.numberOfReleasesSinceSort = 0;
         }
 
         ~GrowingMemoryPool()
         {
-            while(firstMemoryRegion) {
-                MemoryRegion *memoryRegion = firstMemoryRegion;
-                firstMemoryRegion = memoryRegion->nextMemoryRegion;
+            releaseMemoryRegions();
+        }
 
-                free(memoryRegion->buffer);
-                delete memoryRegion;
+        GrowingMemoryPool & operator =(GrowingMemoryPool &&growingMemoryPool)
+        {
+            if(this != &growingMemoryPool) {
+                releaseMemoryRegions();
+
+                FixedPool::operator =(std::move(growingMemoryPool));
+                growByNumberOfBlocks = growingMemoryPool.growByNumberOfBlocks;
+                memoryRegionType = growingMemoryPool.memoryRegionType;
+                firstMemoryRegion = growingMemoryPool.firstMemoryRegion;
+                sortThreshold = growingMemoryPool.sortThreshold;
+                numberOfReleasesSinceSort = growingMemoryPool.numberOfReleasesSinceSort;
+
+                growingMemoryPool.firstMemoryRegion = NULL;
+                growingMemoryPool.numberOfReleasesSinceSort = 0;
             }
+
+            return *this;
         }
 
         DataType *allocateBlock()
         {
-            void *pointer = ::inlinedAllocateBlock(this);
+            DataType *data = allocateUninitialized();
+            new (data) DataType;
 
-            if(!pointer) {
-                allocateNewMemoryRegion();
-                pointer = ::inlinedAllocateBlock(this);
-            }
+            return data;
+        }
 
-            DataType *data = static_cast<DataType *>(pointer);
-            new (data) DataType;
+        // Constructs the block from given arguments, instead of default
+        // construction followed by assignment
+        template <class... Args>
+        DataType *construct(Args &&... args)
+        {
+            DataType *data = allocateUninitialized();
+
+            try {
+                new (data) DataType(std::forward<Args>(args)...);
+            } catch(...) {
+                FixedPool::releaseBlock(data);
+                throw;
+            }
 
             return data;
         }
 
+        // Block is not constructed, it must be released by releaseUninitialized
+        DataType *allocateUninitialized()
+        {
+            if(FixedPool::isExhausted())
+                allocateNewMemoryRegion();
+
+            return static_cast<DataType *>(FixedPool::allocateBlock());
+        }
+
         void releaseBlock(DataType *pointer)
         {
             pointer->~DataType();
-            ::inlinedReleaseBlock(this, pointer);
+            releaseUninitialized(pointer);
         }
 
+        void releaseUninitialized(DataType *pointer)
+        {
+            FixedPool::releaseBlock(pointer);
+
+            if(sortThreshold && ++numberOfReleasesSinceSort >= sortThreshold)
+                sortFreeList();
+        }
+
+        // Orders free blocks by address, so that blocks allocated next are
+        // adjacent in memory again. Returns number of free blocks.
+        std::size_t sortFreeList()
+        {
+            numberOfReleasesSinceSort = 0;
+            return ::inlinedSortFreeList(this);
+        }
+
+        // Sorts the list of free blocks after every numberOfReleases released
+        // blocks, 0 disables it.
+        void setSortThreshold(std::size_t numberOfReleases)
+        {
+            sortThreshold = numberOfReleases;
+            numberOfReleasesSinceSort = 0;
+        }
+
+        // Returns number of bytes given back to the system
+        std::size_t trim()
+        {
+            return ::trimMemoryRegions(this, firstMemoryRegion, memoryRegionType);
+        }
+
+#ifdef MEMORY_POOL_STATISTICS
+        using FixedPool::getStatistics;
+#endif
+
 
     private:
 
@@ -85,22 +174,46 @@ class GrowingMemoryPool : protected MemoryPool
         {
             MemoryRegion *nextMemoryRegion;
             void *buffer;
+            std::size_t size;
+            std::size_t numberOfBlocks;
         };
 
         std::size_t growByNumberOfBlocks;
+        MemoryRegionType memoryRegionType;
         MemoryRegion *firstMemoryRegion;
+        std::size_t sortThreshold;
+        std::size_t numberOfReleasesSinceSort;
 
-        void allocateNewMemoryRegion()
+        void releaseMemoryRegions()
         {
-            unsigned blockSize = sizeof(DataType);
-            if(blockSize < MIN_MEMORY_POOL_BLOCK_SIZE)
-                blockSize = MIN_MEMORY_POOL_BLOCK_SIZE;
+            while(firstMemoryRegion) {
+                MemoryRegion *memoryRegion = firstMemoryRegion;
+                firstMemoryRegion = memoryRegion->nextMemoryRegion;
+
+                ::releaseMemoryRegion(memoryRegion->buffer, memoryRegion->size, memoryRegionType);
+                delete memoryRegion;
+            }
+        }
 
+        void allocateNewMemoryRegion()
+        {
             MemoryRegion *memoryRegion = new MemoryRegion;
+            std::size_t size = FixedPool::getMemoryRegionSize(growByNumberOfBlocks);
+            void *buffer = ::allocateMemoryRegion(size, memoryRegionType);
+
+            if(!buffer) {
+                delete memoryRegion;
+                throw std::bad_alloc();
+            }
+
             memoryRegion->nextMemoryRegion = firstMemoryRegion;
-            memoryRegion->buffer = malloc(blockSize * growByNumberOfBlocks);
+            memoryRegion->buffer = buffer;
+            memoryRegion->size = size;
+            // Rounded up memory region may hold more blocks than requested
+            memoryRegion->numberOfBlocks = FixedPool::getNumberOfBlocks(size);
+            firstMemoryRegion = memoryRegion;
 
-            ::initializeMemoryPool(this, memoryRegion->buffer, growByNumberOfBlocks, sizeof(DataType));
+            FixedPool::extend(buffer, memoryRegion->numberOfBlocks);
         }
 
         GrowingMemoryPool(const GrowingMemoryPool &growingMemoryPool);
@@ -0,0 +1,129 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef GrowingSizeClassAllocatorH
+#define GrowingSizeClassAllocatorH
+
+#include <new>
+#include <cstdlib>
+#include <stdexcept>
+#include "SizeClassAllocator.h"
+
+class GrowingSizeClassAllocator : protected SizeClassAllocator
+{
+    public:
+
+        GrowingSizeClassAllocator(std::size_t growByNumberOfBlocks,
+            const std::size_t *blockSizes = ::defaultSizeClasses,
+            std::size_t numberOfSizeClasses = ::numberOfDefaultSizeClasses) :
+            growByNumberOfBlocks(growByNumberOfBlocks),
+            firstMemoryRegion(NULL)
+        {
+            MemoryPool *memoryPools = new MemoryPool[numberOfSizeClasses];
+            if(!::inlinedInitializeSizeClassAllocator(this, memoryPools, blockSizes, numberOfSizeClasses)) {
+                delete [] memoryPools;
+                throw std::invalid_argument("Block sizes must be ascending and hold a pointer");
+            }
+        }
+
+        ~GrowingSizeClassAllocator()
+        {
+            while(firstMemoryRegion) {
+                MemoryRegion *memoryRegion = firstMemoryRegion;
+                firstMemoryRegion = memoryRegion->nextMemoryRegion;
+
+                free(memoryRegion->buffer);
+                delete memoryRegion;
+            }
+
+            delete [] memoryPools;
+        }
+
+        void *allocateBlock(std::size_t size)
+        {
+            std::size_t sizeClass = ::inlinedGetSizeClass(this, size);
+
+            if(sizeClass >= numberOfSizeClasses)
+                return malloc(size);
+
+            MemoryPool *memoryPool = &memoryPools[sizeClass];
+            void *pointer = ::inlinedAllocateBlock(memoryPool);
+
+            if(!pointer) {
+                allocateNewMemoryRegion(memoryPool);
+                pointer = ::inlinedAllocateBlock(memoryPool);
+            }
+
+            return pointer;
+        }
+
+        void releaseBlock(void *pointer, std::size_t size)
+        {
+            std::size_t sizeClass = ::inlinedGetSizeClass(this, size);
+
+            if(sizeClass >= numberOfSizeClasses)
+                free(pointer);
+            else
+                ::inlinedReleaseBlock(&memoryPools[sizeClass], pointer);
+        }
+
+
+    private:
+
+        struct MemoryRegion
+        {
+            MemoryRegion *nextMemoryRegion;
+            void *buffer;
+        };
+
+        std::size_t growByNumberOfBlocks;
+        MemoryRegion *firstMemoryRegion;
+
+        void allocateNewMemoryRegion(MemoryPool *memoryPool)
+        {
+            MemoryRegion *memoryRegion = new MemoryRegion;
+            memoryRegion->nextMemoryRegion = firstMemoryRegion;
+            memoryRegion->buffer = malloc(memoryPool->blockSize * growByNumberOfBlocks);
+
+            if(!memoryRegion->buffer) {
+                delete memoryRegion;
+                throw std::bad_alloc();
+            }
+
+            firstMemoryRegion = memoryRegion;
+            ::inlinedExtendMemoryPool(memoryPool, memoryRegion->buffer, growByNumberOfBlocks);
+        }
+
+        GrowingSizeClassAllocator(const GrowingSizeClassAllocator &growingSizeClassAllocator);
+        GrowingSizeClassAllocator & operator =(const GrowingSizeClassAllocator &growingSizeClassAllocator);
+};
+
+#endif
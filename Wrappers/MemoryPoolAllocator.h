@@ -33,14 +33,241 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #define MemoryPoolAllocatorH
 
 #include <memory>
+#include <vector>
 #include <cstdlib>
-#include "MemoryPool.h"
+#include <utility>
+#include <type_traits>
+#include "FixedMemoryPool.h"
+#include "MemoryRegion.h"
 
-template <class T>
-class MemoryPoolAllocator : protected MemoryPool
+class MemoryPoolAllocatorBlockPoolBase
 {
     public:
 
+        virtual ~MemoryPoolAllocatorBlockPoolBase()
+        {
+        }
+
+        virtual std::size_t trim() = 0;
+};
+
+// Memory pool of blocks of single size and alignment, shared by all allocators
+// of which value type fits into such block
+template <std::size_t BlockSize, std::size_t Alignment>
+class MemoryPoolAllocatorBlockPool : public MemoryPoolAllocatorBlockPoolBase,
+    protected FixedMemoryPool<BlockSize, Alignment>
+{
+    public:
+
+        typedef FixedMemoryPool<BlockSize, Alignment> FixedPool;
+
+        // Arrays up to this number of blocks are carved from memory regions
+        static const std::size_t maxNumberOfContiguousBlocks = 32;
+
+        MemoryPoolAllocatorBlockPool(std::size_t growByNumberOfBlocks,
+            MemoryRegionType memoryRegionType) :
+            growByNumberOfBlocks(growByNumberOfBlocks),
+            memoryRegionType(memoryRegionType),
+            firstMemoryRegion(NULL)
+        {
+            for(std::size_t numberOfBlocks = 0; numberOfBlocks <= maxNumberOfContiguousBlocks;
+                numberOfBlocks++)
+                firstFreeArrays[numberOfBlocks] = NULL;
+        }
+
+        ~MemoryPoolAllocatorBlockPool()
+        {
+            while(firstMemoryRegion) {
+                MemoryRegion *memoryRegion = firstMemoryRegion;
+                firstMemoryRegion = memoryRegion->nextMemoryRegion;
+
+                ::releaseMemoryRegion(memoryRegion->buffer, memoryRegion->size, memoryRegionType);
+                delete memoryRegion;
+            }
+        }
+
+        void *allocateBlock()
+        {
+            if(FixedPool::isExhausted())
+                allocateNewMemoryRegion();
+
+            return FixedPool::allocateBlock();
+        }
+
+        void releaseBlock(void *pointer)
+        {
+            FixedPool::releaseBlock(pointer);
+        }
+
+        void *allocateArray(std::size_t numberOfBlocks)
+        {
+            void *data = firstFreeArrays[numberOfBlocks];
+            if(data) {
+                firstFreeArrays[numberOfBlocks] = *static_cast<void **>(data);
+#ifdef MEMORY_POOL_STATISTICS
+                ::inlinedCountAllocatedBlocks(this, numberOfBlocks, numberOfBlocks);
+#endif
+                return data;
+            }
+
+            if(numberOfBlocks > this->numberOfNotYetUsedBlocks) {
+                // Blocks left in current memory region are used as single ones
+                ::inlinedReleaseNotYetUsedBlocks(this);
+                allocateNewMemoryRegion();
+            }
+
+            return ::inlinedAllocateContiguousBlocks(this, numberOfBlocks);
+        }
+
+        // Released arrays are kept by their number of blocks for reuse
+        void releaseArray(void *pointer, std::size_t numberOfBlocks)
+        {
+#ifdef MEMORY_POOL_STATISTICS
+            ::inlinedCountReleasedBlocks(this, numberOfBlocks);
+#endif
+            *static_cast<void **>(pointer) = firstFreeArrays[numberOfBlocks];
+            firstFreeArrays[numberOfBlocks] = pointer;
+        }
+
+        std::size_t trim()
+        {
+            return ::trimMemoryRegions(this, firstMemoryRegion, memoryRegionType);
+        }
+
+#ifdef MEMORY_POOL_STATISTICS
+        using FixedPool::getStatistics;
+#endif
+
+
+    private:
+
+        struct MemoryRegion
+        {
+            MemoryRegion *nextMemoryRegion;
+            void *buffer;
+            std::size_t size;
+            std::size_t numberOfBlocks;
+        };
+
+        const std::size_t growByNumberOfBlocks;
+        const MemoryRegionType memoryRegionType;
+        MemoryRegion *firstMemoryRegion;
+        void *firstFreeArrays[maxNumberOfContiguousBlocks + 1];
+
+        void allocateNewMemoryRegion()
+        {
+            MemoryRegion *memoryRegion = new MemoryRegion;
+            std::size_t size = FixedPool::getMemoryRegionSize(growByNumberOfBlocks);
+            void *buffer = ::allocateMemoryRegion(size, memoryRegionType);
+
+            if(!buffer) {
+                delete memoryRegion;
+                throw std::bad_alloc();
+            }
+
+            memoryRegion->nextMemoryRegion = firstMemoryRegion;
+            memoryRegion->buffer = buffer;
+            memoryRegion->size = size;
+            // Rounded up memory region may hold more blocks than requested
+            memoryRegion->numberOfBlocks = FixedPool::getNumberOfBlocks(size);
+            firstMemoryRegion = memoryRegion;
+
+            FixedPool::extend(buffer, memoryRegion->numberOfBlocks);
+        }
+
+        MemoryPoolAllocatorBlockPool(const MemoryPoolAllocatorBlockPool &blockPool);
+        MemoryPoolAllocatorBlockPool & operator =(const MemoryPoolAllocatorBlockPool &blockPool);
+};
+
+// State shared by reference counting between all copies of an allocator,
+// including rebound ones. It keeps single memory pool per block size and
+// alignment, created on first use. It is not synchronized, so allocators
+// sharing it must not be used by multiple threads at the same time.
+class MemoryPoolAllocatorState
+{
+    public:
+
+        const std::size_t growByNumberOfBlocks;
+        const MemoryRegionType memoryRegionType;
+
+        MemoryPoolAllocatorState(std::size_t growByNumberOfBlocks,
+            MemoryRegionType memoryRegionType) :
+            growByNumberOfBlocks(growByNumberOfBlocks),
+            memoryRegionType(memoryRegionType)
+        {
+        }
+
+        ~MemoryPoolAllocatorState()
+        {
+            for(std::size_t i = 0; i < blockPools.size(); i++)
+                delete blockPools[i].blockPool;
+        }
+
+        // Containers rebind allocators rarely, so linear search is enough
+        template <std::size_t BlockSize, std::size_t Alignment>
+        MemoryPoolAllocatorBlockPool<BlockSize, Alignment> *getBlockPool()
+        {
+            typedef MemoryPoolAllocatorBlockPool<BlockSize, Alignment> BlockPool;
+
+            for(std::size_t i = 0; i < blockPools.size(); i++) {
+                if(blockPools[i].blockSize == BlockSize && blockPools[i].alignment == Alignment)
+                    return static_cast<BlockPool *>(blockPools[i].blockPool);
+            }
+
+            BlockPool *blockPool = new BlockPool(growByNumberOfBlocks, memoryRegionType);
+            BlockPoolEntry entry = { BlockSize, Alignment, blockPool };
+
+            try {
+                blockPools.push_back(entry);
+            } catch(...) {
+                delete blockPool;
+                throw;
+            }
+
+            return blockPool;
+        }
+
+        // Returns number of bytes given back to the system by all memory pools
+        std::size_t trim()
+        {
+            std::size_t size = 0;
+            for(std::size_t i = 0; i < blockPools.size(); i++)
+                size += blockPools[i].blockPool->trim();
+
+            return size;
+        }
+
+
+    private:
+
+        struct BlockPoolEntry
+        {
+            std::size_t blockSize;
+            std::size_t alignment;
+            MemoryPoolAllocatorBlockPoolBase *blockPool;
+        };
+
+        std::vector<BlockPoolEntry> blockPools;
+
+        MemoryPoolAllocatorState(const MemoryPoolAllocatorState &state);
+        MemoryPoolAllocatorState & operator =(const MemoryPoolAllocatorState &state);
+};
+
+template <class T, std::size_t Alignment = alignof(T)>
+class MemoryPoolAllocator
+{
+    template <class U, std::size_t OtherAlignment>
+    friend class MemoryPoolAllocator;
+
+    public:
+
+        // Alignment is kept as given on rebind, since the type rebound to may
+        // be incomplete yet, as the control block of std::allocate_shared is
+        static constexpr std::size_t blockAlignment = Alignment > alignof(T) ? Alignment : alignof(T);
+
+        typedef MemoryPoolAllocatorBlockPool<
+            FixedMemoryPool<sizeof(T), blockAlignment>::alignedBlockSize, blockAlignment> BlockPool;
+
         typedef std::size_t size_type;
         typedef std::ptrdiff_t difference_type;
         typedef T *pointer;
@@ -49,53 +276,77 @@ class MemoryPoolAllocator : protected MemoryPool
         typedef const T &const_reference;
         typedef T value_type;
 
+        // Allocator follows the container, so blocks are always released to
+        // the memory pool they come from
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+        typedef std::false_type is_always_equal;
+
         template <class U>
         struct rebind
         {
-            typedef MemoryPoolAllocator<U> other;
+            typedef MemoryPoolAllocator<U, Alignment> other;
         };
 
-        const size_type growByNumberOfBlocks;
+        // Arrays up to this number of elements are carved from memory regions,
+        // bigger ones are allocated by operator new.
+        static const size_type maxNumberOfContiguousElements = BlockPool::maxNumberOfContiguousBlocks;
 
-        MemoryPoolAllocator(size_type growByNumberOfBlocks = 1024) :
-            growByNumberOfBlocks(growByNumberOfBlocks),
-            firstMemoryRegion(NULL)
+        MemoryPoolAllocator(size_type growByNumberOfBlocks = 1024,
+            MemoryRegionType memoryRegionType = DefaultMemoryRegion) :
+            state(std::make_shared<MemoryPoolAllocatorState>(growByNumberOfBlocks, memoryRegionType)),
+            blockPool(NULL)
         {
-            ::initializeMemoryPool(this, NULL, 0, sizeof(T));
         }
 
-        MemoryPoolAllocator(const MemoryPoolAllocator &allocator) :
-            growByNumberOfBlocks(allocator.growByNumberOfBlocks),
-            firstMemoryRegion(NULL)
+        // Copies do not throw, as the standard requires. Memory pool of the
+        // rebound type is looked up, or created, on its first use.
+        MemoryPoolAllocator(const MemoryPoolAllocator &allocator) noexcept :
+            state(allocator.state),
+            blockPool(allocator.blockPool)
         {
-            ::initializeMemoryPool(this, NULL, 0, sizeof(T));
         }
 
-        template <class U>
-        MemoryPoolAllocator(const MemoryPoolAllocator<U> &other) :
-            growByNumberOfBlocks(other.growByNumberOfBlocks),
-            firstMemoryRegion(NULL)
+        template <class U, std::size_t OtherAlignment>
+        MemoryPoolAllocator(const MemoryPoolAllocator<U, OtherAlignment> &other) noexcept :
+            state(other.state),
+            blockPool(NULL)
         {
-            ::initializeMemoryPool(this, NULL, 0, sizeof(T));
         }
 
-        ~MemoryPoolAllocator()
+        MemoryPoolAllocator & operator =(const MemoryPoolAllocator &allocator) noexcept
         {
-            while(firstMemoryRegion) {
-                MemoryRegion *memoryRegion = firstMemoryRegion;
-                firstMemoryRegion = memoryRegion->nextMemoryRegion;
+            state = allocator.state;
+            blockPool = allocator.blockPool;
+            return *this;
+        }
 
-                free(memoryRegion->buffer);
-                delete memoryRegion;
-            }
+        size_type getGrowByNumberOfBlocks() const
+        {
+            return state->growByNumberOfBlocks;
+        }
+
+        MemoryRegionType getMemoryRegionType() const
+        {
+            return state->memoryRegionType;
         }
 
-        pointer allocate(size_type n, std::allocator<void>::const_pointer hint = 0)
+        // Where memory comes from depends on n only, so deallocate finds it
+        // by the same n as given to allocate.
+        pointer allocate(size_type n, const void *hint = 0)
         {
-            if(n != 1 || hint)
+            if(hint)
                 throw std::bad_alloc();
 
-            pointer p = allocateBlock();
+            pointer p;
+            if(n == 1)
+                p = static_cast<pointer>(getBlockPool()->allocateBlock());
+            else if(isContiguousArray(n))
+                p = static_cast<pointer>(getBlockPool()->allocateArray(getNumberOfArrayBlocks(n)));
+            else
+                p = allocateUpstreamArray(n);
+
             if(!p)
                 throw std::bad_alloc();
 
@@ -104,54 +355,119 @@ class MemoryPoolAllocator : protected MemoryPool
 
         void deallocate(pointer p, size_type n)
         {
-            ::inlinedReleaseBlock(this, p);
+            if(n == 1)
+                getBlockPool()->releaseBlock(p);
+            else if(isContiguousArray(n))
+                getBlockPool()->releaseArray(p, getNumberOfArrayBlocks(n));
+            else
+                releaseUpstreamArray(p);
         }
 
-        void construct(pointer p, const_reference val)
+        // Elements are constructed in place from any arguments, as emplace
+        // functions of containers require
+        template <class U, class... Args>
+        void construct(U *p, Args &&... args)
         {
-            new (p) T(val);
+            new (p) U(std::forward<Args>(args)...);
         }
 
-        void destroy(pointer p)
+        template <class U>
+        void destroy(U *p)
         {
-            p->~T();
+            p->~U();
         }
 
+        // Returns number of bytes given back to the system by memory pools of
+        // all block sizes
+        std::size_t trim()
+        {
+            return state->trim();
+        }
 
-    private:
+#ifdef MEMORY_POOL_STATISTICS
+        MemoryPoolSnapshot getStatistics() const
+        {
+            return getBlockPool()->getStatistics();
+        }
+#endif
 
-        struct MemoryRegion
+        // Allocators are equal when they share the state, so blocks allocated
+        // by one of them can be released by the other
+        template <class U, std::size_t OtherAlignment>
+        bool operator ==(const MemoryPoolAllocator<U, OtherAlignment> &other) const
         {
-            MemoryRegion *nextMemoryRegion;
-            void *buffer;
-        };
+            return state == other.state;
+        }
 
-        MemoryRegion *firstMemoryRegion;
+        template <class U, std::size_t OtherAlignment>
+        bool operator !=(const MemoryPoolAllocator<U, OtherAlignment> &other) const
+        {
+            return state != other.state;
+        }
 
-        void allocateNewMemoryRegion()
+
+    private:
+
+        std::shared_ptr<MemoryPoolAllocatorState> state;
+        mutable BlockPool *blockPool;
+
+        // The memory pool already exists, when memory has been allocated from
+        // it, so deallocate does not throw
+        BlockPool *getBlockPool() const
         {
-            unsigned blockSize = sizeof(T);
-            if(blockSize < MIN_MEMORY_POOL_BLOCK_SIZE)
-                blockSize = MIN_MEMORY_POOL_BLOCK_SIZE;
+            if(!blockPool)
+                blockPool = state->getBlockPool<BlockPool::FixedPool::alignedBlockSize, blockAlignment>();
 
-            MemoryRegion *memoryRegion = new MemoryRegion;
-            memoryRegion->nextMemoryRegion = firstMemoryRegion;
-            memoryRegion->buffer = malloc(blockSize * growByNumberOfBlocks);
+            return blockPool;
+        }
 
-            ::initializeMemoryPool(this, memoryRegion->buffer, growByNumberOfBlocks, sizeof(T));
+        size_type getNumberOfArrayBlocks(size_type n) const
+        {
+            return (n * sizeof(T) + BlockPool::FixedPool::alignedBlockSize - 1) /
+                BlockPool::FixedPool::alignedBlockSize;
         }
 
-        pointer allocateBlock()
+        // Decided without the memory pool, which upstream arrays do not need
+        bool isContiguousArray(size_type n) const
         {
-            void *data = ::inlinedAllocateBlock(this);
+            return n > 1 && n <= maxNumberOfContiguousElements &&
+                getNumberOfArrayBlocks(n) <= state->growByNumberOfBlocks;
+        }
 
-            if(!data) {
-                allocateNewMemoryRegion();
-                data = ::inlinedAllocateBlock(this);
-            }
+        // Arrays bigger than maxNumberOfContiguousElements are aligned manually,
+        // with the pointer returned by operator new stored just before them
+        pointer allocateUpstreamArray(size_type n)
+        {
+            if(n > (std::size_t(-1) - blockAlignment - sizeof(void *)) / sizeof(T))
+                throw std::bad_alloc();
+
+            std::uint8_t *buffer = static_cast<std::uint8_t *>(
+                ::operator new(n * sizeof(T) + blockAlignment + sizeof(void *)));
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(buffer + sizeof(void *));
+            address = (address + blockAlignment - 1) & ~(std::uintptr_t(blockAlignment) - 1);
+
+            void **data = reinterpret_cast<void **>(address);
+            data[-1] = buffer;
 
-            return static_cast<pointer>(data);
+            return reinterpret_cast<pointer>(data);
+        }
+
+        void releaseUpstreamArray(pointer p)
+        {
+            ::operator delete(reinterpret_cast<void **>(p)[-1]);
         }
 };
 
+// Creates object owned by std::shared_ptr, of which control block and the object
+// itself are placed in single block of the memory pool shared by copies of the
+// allocator. The allocator may be of any value type. The control block keeps
+// a copy of it, so the memory pool lives as long as any object created by it.
+template <class T, class U, std::size_t Alignment, class... Args>
+std::shared_ptr<T> allocatePooledShared(const MemoryPoolAllocator<U, Alignment> &allocator,
+    Args &&... args)
+{
+    return std::allocate_shared<T>(MemoryPoolAllocator<T, Alignment>(allocator),
+        std::forward<Args>(args)...);
+}
+
 #endif
@@ -0,0 +1,257 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef MemoryPoolStatisticsH
+#define MemoryPoolStatisticsH
+
+#include "MemoryPool.h"
+
+#ifdef MEMORY_POOL_STATISTICS
+
+#include <string>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <functional>
+
+struct MemoryPoolSnapshot
+{
+    std::size_t blockSize;
+    MemoryPoolStatistics statistics;
+};
+
+struct NamedMemoryPoolSnapshot
+{
+    std::string name;
+    MemoryPoolSnapshot snapshot;
+};
+
+// Registered memory pools are exported by name. When memory pool is used by
+// other thread than the exporting one, the mutex guarding it must be given
+// at registration, so that its statistics are copied consistently.
+class MemoryPoolStatisticsRegistry
+{
+    public:
+
+        static MemoryPoolStatisticsRegistry &getSingleInstance()
+        {
+            static MemoryPoolStatisticsRegistry registry;
+            return registry;
+        }
+
+        template <class MemoryPoolType>
+        void registerMemoryPool(const std::string &name, const MemoryPoolType &memoryPool,
+            std::mutex *memoryPoolMutex = NULL)
+        {
+            RegisteredMemoryPool registeredMemoryPool;
+            registeredMemoryPool.name = name;
+            registeredMemoryPool.memoryPool = &memoryPool;
+            registeredMemoryPool.takeSnapshot = [&memoryPool, memoryPoolMutex]() {
+                if(!memoryPoolMutex)
+                    return memoryPool.getStatistics();
+
+                std::lock_guard<std::mutex> lock(*memoryPoolMutex);
+                return memoryPool.getStatistics();
+            };
+
+            std::lock_guard<std::mutex> lock(mutex);
+            registeredMemoryPools.push_back(registeredMemoryPool);
+        }
+
+        // Must be called before the memory pool is destroyed
+        void unregisterMemoryPool(const void *memoryPool)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            for(RegisteredMemoryPoolIterator iterator = registeredMemoryPools.begin();
+                iterator != registeredMemoryPools.end(); ) {
+                if(iterator->memoryPool == memoryPool)
+                    iterator = registeredMemoryPools.erase(iterator);
+                else
+                    ++iterator;
+            }
+        }
+
+        std::vector<NamedMemoryPoolSnapshot> takeSnapshot()
+        {
+            std::vector<NamedMemoryPoolSnapshot> snapshots;
+            std::lock_guard<std::mutex> lock(mutex);
+
+            for(RegisteredMemoryPoolIterator iterator = registeredMemoryPools.begin();
+                iterator != registeredMemoryPools.end(); ++iterator) {
+                NamedMemoryPoolSnapshot snapshot;
+                snapshot.name = iterator->name;
+                snapshot.snapshot = iterator->takeSnapshot();
+                snapshots.push_back(snapshot);
+            }
+
+            return snapshots;
+        }
+
+        std::string exportJson()
+        {
+            std::vector<NamedMemoryPoolSnapshot> snapshots = takeSnapshot();
+            std::ostringstream stream;
+
+            stream << "{\"memoryPools\":[";
+            for(std::size_t index = 0; index < snapshots.size(); index++) {
+                const MemoryPoolSnapshot &snapshot = snapshots[index].snapshot;
+
+                if(index)
+                    stream << ',';
+
+                stream << "{\"name\":\"" << escapeJsonString(snapshots[index].name) << '"'
+                    << ",\"blockSize\":" << snapshot.blockSize
+                    << ",\"allocations\":" << snapshot.statistics.numberOfAllocations
+                    << ",\"failedAllocations\":" << snapshot.statistics.numberOfFailedAllocations
+                    << ",\"releases\":" << snapshot.statistics.numberOfReleases
+                    << ",\"liveBlocks\":" << snapshot.statistics.numberOfLiveBlocks
+                    << ",\"maxLiveBlocks\":" << snapshot.statistics.maxNumberOfLiveBlocks
+                    << ",\"memoryRegions\":" << snapshot.statistics.numberOfMemoryRegions
+                    << '}';
+            }
+            stream << "]}";
+
+            return stream.str();
+        }
+
+        std::string exportPrometheus()
+        {
+            std::vector<NamedMemoryPoolSnapshot> snapshots = takeSnapshot();
+            std::ostringstream stream;
+
+            exportPrometheusMetric(stream, snapshots, "block_size_bytes", "gauge",
+                "Size of single block.", &MemoryPoolSnapshot::blockSize, NULL);
+            exportPrometheusMetric(stream, snapshots, "allocations_total", "counter",
+                "Number of allocated blocks.", NULL, &MemoryPoolStatistics::numberOfAllocations);
+            exportPrometheusMetric(stream, snapshots, "failed_allocations_total", "counter",
+                "Number of blocks, which could not be allocated.", NULL,
+                &MemoryPoolStatistics::numberOfFailedAllocations);
+            exportPrometheusMetric(stream, snapshots, "releases_total", "counter",
+                "Number of released blocks.", NULL, &MemoryPoolStatistics::numberOfReleases);
+            exportPrometheusMetric(stream, snapshots, "live_blocks", "gauge",
+                "Number of allocated and not yet released blocks.", NULL,
+                &MemoryPoolStatistics::numberOfLiveBlocks);
+            exportPrometheusMetric(stream, snapshots, "max_live_blocks", "gauge",
+                "Highest number of live blocks.", NULL, &MemoryPoolStatistics::maxNumberOfLiveBlocks);
+            exportPrometheusMetric(stream, snapshots, "memory_regions", "gauge",
+                "Number of memory regions.", NULL, &MemoryPoolStatistics::numberOfMemoryRegions);
+
+            return stream.str();
+        }
+
+
+    private:
+
+        struct RegisteredMemoryPool
+        {
+            std::string name;
+            const void *memoryPool;
+            std::function<MemoryPoolSnapshot()> takeSnapshot;
+        };
+
+        typedef std::list<RegisteredMemoryPool> RegisteredMemoryPoolList;
+        typedef RegisteredMemoryPoolList::iterator RegisteredMemoryPoolIterator;
+
+        RegisteredMemoryPoolList registeredMemoryPools;
+        std::mutex mutex;
+
+        // JSON strings must not contain any control character
+        static std::string escapeJsonString(const std::string &text)
+        {
+            static const char hexadecimalDigits[] = "0123456789abcdef";
+            std::string escapedText;
+
+            for(std::size_t index = 0; index < text.size(); index++) {
+                unsigned char character = static_cast<unsigned char>(text[index]);
+
+                if(character == '"' || character == '\\') {
+                    escapedText += '\\';
+                    escapedText += text[index];
+                } else if(character == '\n') {
+                    escapedText += "\\n";
+                } else if(character == '\r') {
+                    escapedText += "\\r";
+                } else if(character == '\t') {
+                    escapedText += "\\t";
+                } else if(character < 0x20) {
+                    escapedText += "\\u00";
+                    escapedText += hexadecimalDigits[character >> 4];
+                    escapedText += hexadecimalDigits[character & 0xF];
+                } else {
+                    escapedText += text[index];
+                }
+            }
+
+            return escapedText;
+        }
+
+        // Prometheus label values escape only backslash, quote and line feed
+        static std::string escapeLabelValue(const std::string &text)
+        {
+            std::string escapedText;
+
+            for(std::size_t index = 0; index < text.size(); index++) {
+                if(text[index] == '"' || text[index] == '\\')
+                    escapedText += '\\';
+                if(text[index] == '\n')
+                    escapedText += "\\n";
+                else
+                    escapedText += text[index];
+            }
+
+            return escapedText;
+        }
+
+        static void exportPrometheusMetric(std::ostringstream &stream,
+            const std::vector<NamedMemoryPoolSnapshot> &snapshots,
+            const char *name, const char *type, const char *help,
+            std::size_t MemoryPoolSnapshot::*snapshotField,
+            std::size_t MemoryPoolStatistics::*statisticsField)
+        {
+            stream << "# HELP fixmemalloc_" << name << ' ' << help << '\n';
+            stream << "# TYPE fixmemalloc_" << name << ' ' << type << '\n';
+
+            for(std::size_t index = 0; index < snapshots.size(); index++) {
+                const MemoryPoolSnapshot &snapshot = snapshots[index].snapshot;
+
+                stream << "fixmemalloc_" << name << "{pool=\""
+                    << escapeLabelValue(snapshots[index].name) << "\"} "
+                    << (snapshotField ? snapshot.*snapshotField : snapshot.statistics.*statisticsField)
+                    << '\n';
+            }
+        }
+};
+
+#endif
+
+#endif
@@ -0,0 +1,247 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef MemoryRegionH
+#define MemoryRegionH
+
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include "MemoryPool.h"
+
+#if defined(__linux__)
+    #include <sys/mman.h>
+#endif
+
+enum MemoryRegionType
+{
+    DefaultMemoryRegion,
+    HugePageMemoryRegion
+};
+
+const std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Size of memory region may be rounded up to the size of memory page. The
+// same size and type must be given when the memory region is released.
+inline void *allocateMemoryRegion(std::size_t &size, MemoryRegionType type)
+{
+    #if defined(__linux__)
+        if(type == HugePageMemoryRegion) {
+            size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+
+            #if defined(MAP_HUGETLB)
+                void *buffer = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if(buffer != MAP_FAILED)
+                    return buffer;
+            #endif
+
+            // No huge pages are reserved, so transparent huge pages are used
+            // instead. Such memory region must be aligned to huge page size.
+            void *reservation = mmap(NULL, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(reservation == MAP_FAILED)
+                return NULL;
+
+            std::uint8_t *begin = static_cast<std::uint8_t *>(reservation);
+            std::uint8_t *aligned = reinterpret_cast<std::uint8_t *>(
+                (reinterpret_cast<std::uintptr_t>(begin) + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+
+            if(aligned != begin)
+                munmap(begin, aligned - begin);
+            munmap(aligned + size, begin + HUGE_PAGE_SIZE - aligned);
+
+            #if defined(MADV_HUGEPAGE)
+                madvise(aligned, size, MADV_HUGEPAGE);
+            #endif
+
+            return aligned;
+        }
+    #endif
+
+    return malloc(size);
+}
+
+inline void releaseMemoryRegion(void *buffer, std::size_t size, MemoryRegionType type)
+{
+    #if defined(__linux__)
+        if(type == HugePageMemoryRegion) {
+            munmap(buffer, size);
+            return;
+        }
+    #endif
+
+    free(buffer);
+}
+
+// Releases memory regions of which all blocks are free and removes those blocks
+// from the memory pool. The MemoryRegion list node must provide nextMemoryRegion,
+// buffer, size and numberOfBlocks fields. Returns number of released bytes.
+template <class MemoryRegion>
+std::size_t trimMemoryRegions(MemoryPool *memoryPool,
+    MemoryRegion *&firstMemoryRegion, MemoryRegionType type)
+{
+    struct MemoryRegionUsage
+    {
+        std::uint8_t *begin;
+        MemoryRegion *memoryRegion;
+        std::size_t numberOfFreeBlocks;
+
+        bool operator <(const MemoryRegionUsage &usage) const
+        {
+            return begin < usage.begin;
+        }
+
+        bool isFree() const
+        {
+            return numberOfFreeBlocks == memoryRegion->numberOfBlocks;
+        }
+    };
+
+    std::vector<MemoryRegionUsage> usages;
+    for(MemoryRegion *memoryRegion = firstMemoryRegion; memoryRegion;
+        memoryRegion = memoryRegion->nextMemoryRegion) {
+        MemoryRegionUsage usage = { static_cast<std::uint8_t *>(memoryRegion->buffer), memoryRegion, 0 };
+        usages.push_back(usage);
+    }
+
+    std::sort(usages.begin(), usages.end());
+
+    // Regions are sorted by address, so owner of block is found by binary search
+    auto findUsage = [&usages](void *pointer) -> MemoryRegionUsage * {
+        MemoryRegionUsage key = { static_cast<std::uint8_t *>(pointer), NULL, 0 };
+        typename std::vector<MemoryRegionUsage>::iterator usage =
+            std::upper_bound(usages.begin(), usages.end(), key);
+        if(usage == usages.begin())
+            return NULL;
+
+        --usage;
+        if(static_cast<std::uint8_t *>(pointer) >= usage->begin + usage->memoryRegion->size)
+            return NULL;
+
+        return &*usage;
+    };
+
+    for(void *block = memoryPool->firstFreeBlock; block; block = *(void **) block) {
+        MemoryRegionUsage *usage = findUsage(block);
+        if(usage)
+            usage->numberOfFreeBlocks++;
+    }
+
+    MemoryRegionUsage *notYetUsedUsage = NULL;
+    if(memoryPool->numberOfNotYetUsedBlocks) {
+        notYetUsedUsage = findUsage(memoryPool->notYetUsedBlocks);
+        if(notYetUsedUsage)
+            notYetUsedUsage->numberOfFreeBlocks += memoryPool->numberOfNotYetUsedBlocks;
+    }
+
+    // Pending runs keep their number of blocks in their second block
+    for(void *run = memoryPool->firstPendingRun; run; run = *(void **) run) {
+        MemoryRegionUsage *usage = findUsage(run);
+        if(usage)
+            usage->numberOfFreeBlocks +=
+                *(std::size_t *) (static_cast<std::uint8_t *>(run) + memoryPool->blockSize);
+    }
+
+    bool anyFree = false;
+    for(std::size_t index = 0; index < usages.size(); index++)
+        anyFree |= usages[index].isFree();
+
+    if(!anyFree)
+        return 0;
+
+    // Unlink blocks of released regions, keeping the order of remaining ones
+    void **link = &memoryPool->firstFreeBlock;
+    for(void *block = memoryPool->firstFreeBlock; block; ) {
+        void *nextBlock = *(void **) block;
+        MemoryRegionUsage *usage = findUsage(block);
+
+        if(!usage || !usage->isFree()) {
+            *link = block;
+            link = (void **) block;
+        }
+
+        block = nextBlock;
+    }
+    *link = NULL;
+
+    if(memoryPool->firstFreeBlock)
+        memoryPool->lastFreeBlock = link;
+
+    void **runLink = &memoryPool->firstPendingRun;
+    for(void *run = memoryPool->firstPendingRun; run; ) {
+        void *nextRun = *(void **) run;
+        MemoryRegionUsage *usage = findUsage(run);
+
+        if(!usage || !usage->isFree()) {
+            *runLink = run;
+            runLink = (void **) run;
+            memoryPool->lastPendingRun = run;
+        }
+
+        run = nextRun;
+    }
+    *runLink = NULL;
+
+    if(notYetUsedUsage && notYetUsedUsage->isFree()) {
+        memoryPool->notYetUsedBlocks = NULL;
+        memoryPool->numberOfNotYetUsedBlocks = 0;
+    }
+
+    std::size_t releasedSize = 0;
+    for(std::size_t index = 0; index < usages.size(); index++)
+        if(usages[index].isFree())
+            usages[index].memoryRegion->numberOfBlocks = 0;
+
+    for(MemoryRegion **memoryRegionLink = &firstMemoryRegion; *memoryRegionLink; ) {
+        MemoryRegion *memoryRegion = *memoryRegionLink;
+
+        if(memoryRegion->numberOfBlocks) {
+            memoryRegionLink = &memoryRegion->nextMemoryRegion;
+            continue;
+        }
+
+        *memoryRegionLink = memoryRegion->nextMemoryRegion;
+        releasedSize += memoryRegion->size;
+
+#ifdef MEMORY_POOL_STATISTICS
+        memoryPool->statistics.numberOfMemoryRegions--;
+#endif
+
+        releaseMemoryRegion(memoryRegion->buffer, memoryRegion->size, type);
+        delete memoryRegion;
+    }
+
+    return releasedSize;
+}
+
+#endif
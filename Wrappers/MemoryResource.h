@@ -0,0 +1,286 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef MemoryResourceH
+#define MemoryResourceH
+
+#include <new>
+#include <mutex>
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+#include <stdexcept>
+#include <memory_resource>
+#include "GrowingMemoryPool.h"
+#include "SizeClassAllocator.h"
+
+// Stands in for std::mutex in unsynchronized memory resources
+struct NullMutex
+{
+    void lock()
+    {
+    }
+
+    void unlock()
+    {
+    }
+};
+
+// Memory resource of single block size. Requests that fit into the block are
+// served by a growing memory pool, all others are passed to the upstream.
+template <std::size_t BlockSize, std::size_t Alignment = alignof(std::max_align_t),
+    class Mutex = NullMutex>
+class MemoryPoolResource : public std::pmr::memory_resource
+{
+    public:
+
+        MemoryPoolResource(std::size_t growByNumberOfBlocks,
+            MemoryRegionType memoryRegionType = DefaultMemoryRegion,
+            std::pmr::memory_resource *upstream = std::pmr::get_default_resource()) :
+            memoryPool(growByNumberOfBlocks, memoryRegionType),
+            upstream(upstream)
+        {
+        }
+
+        std::pmr::memory_resource *getUpstreamResource() const
+        {
+            return upstream;
+        }
+
+        // Returns number of bytes given back to the system
+        std::size_t trim()
+        {
+            std::lock_guard<Mutex> lock(mutex);
+            return memoryPool.trim();
+        }
+
+
+    protected:
+
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            if(!isPooled(bytes, alignment))
+                return upstream->allocate(bytes, alignment);
+
+            std::lock_guard<Mutex> lock(mutex);
+            return memoryPool.allocateBlock();
+        }
+
+        void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override
+        {
+            if(!isPooled(bytes, alignment)) {
+                upstream->deallocate(pointer, bytes, alignment);
+                return;
+            }
+
+            std::lock_guard<Mutex> lock(mutex);
+            memoryPool.releaseBlock(static_cast<Block *>(pointer));
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+
+
+    private:
+
+        struct alignas(Alignment) Block
+        {
+            std::uint8_t data[BlockSize];
+        };
+
+        GrowingMemoryPool<Block, Alignment> memoryPool;
+        std::pmr::memory_resource *upstream;
+        Mutex mutex;
+
+        static bool isPooled(std::size_t bytes, std::size_t alignment)
+        {
+            return bytes <= BlockSize && alignment <= Alignment;
+        }
+
+        MemoryPoolResource(const MemoryPoolResource &memoryPoolResource);
+        MemoryPoolResource & operator =(const MemoryPoolResource &memoryPoolResource);
+};
+
+// Memory resource of many block sizes. Requests are routed to memory pools of
+// the size classes, which take memory regions from the upstream. Requests too
+// big for any size class or aligned more than std::max_align_t are passed to
+// the upstream directly.
+template <class Mutex = NullMutex>
+class PooledMemoryResource : public std::pmr::memory_resource, protected SizeClassAllocator
+{
+    public:
+
+        PooledMemoryResource(std::size_t growByNumberOfBlocks,
+            std::pmr::memory_resource *upstream = std::pmr::get_default_resource(),
+            const std::size_t *blockSizes = ::defaultSizeClasses,
+            std::size_t numberOfSizeClasses = ::numberOfDefaultSizeClasses) :
+            growByNumberOfBlocks(growByNumberOfBlocks),
+            upstream(upstream),
+            firstMemoryRegion(NULL)
+        {
+            MemoryPool *memoryPools = new MemoryPool[numberOfSizeClasses];
+            if(!::inlinedInitializeSizeClassAllocator(this, memoryPools, blockSizes, numberOfSizeClasses)) {
+                delete [] memoryPools;
+                throw std::invalid_argument("Block sizes must be ascending and hold a pointer");
+            }
+        }
+
+        ~PooledMemoryResource()
+        {
+            releaseMemoryRegions();
+            delete [] memoryPools;
+        }
+
+        std::pmr::memory_resource *getUpstreamResource() const
+        {
+            return upstream;
+        }
+
+        // Gives all memory regions back to the upstream, even if blocks
+        // allocated from them were not deallocated
+        void release()
+        {
+            std::lock_guard<Mutex> lock(mutex);
+
+            releaseMemoryRegions();
+            for(std::size_t sizeClass = 0; sizeClass < numberOfSizeClasses; sizeClass++) {
+                ::inlinedInitializeMemoryPool(&memoryPools[sizeClass], NULL, 0,
+                    memoryPools[sizeClass].blockSize);
+            }
+        }
+
+
+    protected:
+
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            std::size_t sizeClass = getSizeClass(bytes, alignment);
+            if(sizeClass >= numberOfSizeClasses)
+                return upstream->allocate(bytes, alignment);
+
+            std::lock_guard<Mutex> lock(mutex);
+
+            MemoryPool *memoryPool = &memoryPools[sizeClass];
+            void *pointer = ::inlinedAllocateBlock(memoryPool);
+
+            if(!pointer) {
+                allocateNewMemoryRegion(memoryPool);
+                pointer = ::inlinedAllocateBlock(memoryPool);
+            }
+
+            return pointer;
+        }
+
+        void do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) override
+        {
+            std::size_t sizeClass = getSizeClass(bytes, alignment);
+            if(sizeClass >= numberOfSizeClasses) {
+                upstream->deallocate(pointer, bytes, alignment);
+                return;
+            }
+
+            std::lock_guard<Mutex> lock(mutex);
+            ::inlinedReleaseBlock(&memoryPools[sizeClass], pointer);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+
+
+    private:
+
+        struct MemoryRegion
+        {
+            MemoryRegion *nextMemoryRegion;
+            void *buffer;
+            std::size_t size;
+        };
+
+        std::size_t growByNumberOfBlocks;
+        std::pmr::memory_resource *upstream;
+        MemoryRegion *firstMemoryRegion;
+        Mutex mutex;
+
+        // Memory regions are aligned to std::max_align_t, so blocks are aligned
+        // as much as their size allows, up to std::max_align_t
+        std::size_t getSizeClass(std::size_t bytes, std::size_t alignment) const
+        {
+            std::size_t sizeClass = ::inlinedGetSizeClass(this, bytes);
+
+            if(sizeClass < numberOfSizeClasses && (alignment > alignof(std::max_align_t) ||
+                (memoryPools[sizeClass].blockSize & (alignment - 1)) != 0))
+                return numberOfSizeClasses;
+
+            return sizeClass;
+        }
+
+        void allocateNewMemoryRegion(MemoryPool *memoryPool)
+        {
+            MemoryRegion *memoryRegion = new MemoryRegion;
+            memoryRegion->size = memoryPool->blockSize * growByNumberOfBlocks;
+
+            try {
+                memoryRegion->buffer = upstream->allocate(memoryRegion->size,
+                    alignof(std::max_align_t));
+            } catch(...) {
+                delete memoryRegion;
+                throw;
+            }
+
+            memoryRegion->nextMemoryRegion = firstMemoryRegion;
+            firstMemoryRegion = memoryRegion;
+            ::inlinedExtendMemoryPool(memoryPool, memoryRegion->buffer, growByNumberOfBlocks);
+        }
+
+        void releaseMemoryRegions()
+        {
+            while(firstMemoryRegion) {
+                MemoryRegion *memoryRegion = firstMemoryRegion;
+                firstMemoryRegion = memoryRegion->nextMemoryRegion;
+
+                upstream->deallocate(memoryRegion->buffer, memoryRegion->size,
+                    alignof(std::max_align_t));
+                delete memoryRegion;
+            }
+        }
+
+        PooledMemoryResource(const PooledMemoryResource &pooledMemoryResource);
+        PooledMemoryResource & operator =(const PooledMemoryResource &pooledMemoryResource);
+};
+
+typedef PooledMemoryResource<NullMutex> UnsynchronizedPooledMemoryResource;
+typedef PooledMemoryResource<std::mutex> SynchronizedPooledMemoryResource;
+
+#endif
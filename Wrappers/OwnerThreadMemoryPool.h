@@ -0,0 +1,157 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef OwnerThreadMemoryPoolH
+#define OwnerThreadMemoryPoolH
+
+#include <new>
+#include <thread>
+#include "OwnedMemoryPool.h"
+#include "FixedMemoryPool.h"
+#include "MemoryRegion.h"
+#include "MemoryPoolStatistics.h"
+
+// Growing memory pool owned by the thread which created it. Only the owner
+// allocates blocks, while any thread may release them.
+template <class DataType, std::size_t Alignment = alignof(DataType)>
+class OwnerThreadMemoryPool : protected OwnedMemoryPool
+{
+    public:
+
+        // Block size and memory region size are computed the same way as for
+        // GrowingMemoryPool
+        typedef FixedMemoryPool<sizeof(DataType), Alignment> FixedPool;
+
+        OwnerThreadMemoryPool(std::size_t growByNumberOfBlocks,
+            MemoryRegionType memoryRegionType = DefaultMemoryRegion) :
+            growByNumberOfBlocks(growByNumberOfBlocks),
+            memoryRegionType(memoryRegionType),
+            owner(std::this_thread::get_id()),
+            firstMemoryRegion(NULL)
+        {
+            ::inlinedInitializeOwnedMemoryPool(this, NULL, 0, FixedPool::alignedBlockSize);
+        }
+
+        // Other threads must not release any block during or after destruction
+        ~OwnerThreadMemoryPool()
+        {
+            while(firstMemoryRegion) {
+                MemoryRegion *memoryRegion = firstMemoryRegion;
+                firstMemoryRegion = memoryRegion->nextMemoryRegion;
+
+                ::releaseMemoryRegion(memoryRegion->buffer, memoryRegion->size, memoryRegionType);
+                delete memoryRegion;
+            }
+        }
+
+        // Must be called by the owner thread only. Blocks released by other
+        // threads are reclaimed before the memory pool grows.
+        DataType *allocateBlock()
+        {
+            if(!memoryPool.firstFreeBlock && !memoryPool.numberOfNotYetUsedBlocks &&
+                !memoryPool.firstPendingRun &&
+                !::inlinedReclaimRemoteBlocks(this))
+                allocateNewMemoryRegion();
+
+            DataType *data = static_cast<DataType *>(::inlinedAllocateBlock(&memoryPool));
+            new (data) DataType;
+
+            return data;
+        }
+
+        void releaseBlock(DataType *pointer)
+        {
+            pointer->~DataType();
+
+            if(std::this_thread::get_id() == owner)
+                ::inlinedReleaseOwnedBlock(this, pointer);
+            else
+                ::inlinedReleaseRemoteBlock(this, pointer);
+        }
+
+        // Takes over blocks released by other threads without waiting for
+        // the pool to run out of free blocks. Must be called by the owner.
+        std::size_t reclaimRemoteBlocks()
+        {
+            return ::inlinedReclaimRemoteBlocks(this);
+        }
+
+#ifdef MEMORY_POOL_STATISTICS
+        // Blocks released by other threads are counted once reclaimed
+        MemoryPoolSnapshot getStatistics() const
+        {
+            MemoryPoolSnapshot snapshot = { memoryPool.blockSize, memoryPool.statistics };
+            return snapshot;
+        }
+#endif
+
+
+    private:
+
+        struct MemoryRegion
+        {
+            MemoryRegion *nextMemoryRegion;
+            void *buffer;
+            std::size_t size;
+            std::size_t numberOfBlocks;
+        };
+
+        std::size_t growByNumberOfBlocks;
+        MemoryRegionType memoryRegionType;
+        std::thread::id owner;
+        MemoryRegion *firstMemoryRegion;
+
+        void allocateNewMemoryRegion()
+        {
+            MemoryRegion *memoryRegion = new MemoryRegion;
+            std::size_t size = FixedPool::getMemoryRegionSize(growByNumberOfBlocks);
+            void *buffer = ::allocateMemoryRegion(size, memoryRegionType);
+
+            if(!buffer) {
+                delete memoryRegion;
+                throw std::bad_alloc();
+            }
+
+            memoryRegion->nextMemoryRegion = firstMemoryRegion;
+            memoryRegion->buffer = buffer;
+            memoryRegion->size = size;
+            // Rounded up memory region may hold more blocks than requested
+            memoryRegion->numberOfBlocks = FixedPool::getNumberOfBlocks(size);
+            firstMemoryRegion = memoryRegion;
+
+            ::inlinedExtendAlignedMemoryPool(&memoryPool, buffer, memoryRegion->numberOfBlocks, Alignment);
+        }
+
+        OwnerThreadMemoryPool(const OwnerThreadMemoryPool &ownerThreadMemoryPool);
+        OwnerThreadMemoryPool & operator =(const OwnerThreadMemoryPool &ownerThreadMemoryPool);
+};
+
+#endif
@@ -0,0 +1,252 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef PersistentMemoryPoolH
+#define PersistentMemoryPoolH
+
+#include <new>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include "IndexedMemoryPool.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Memory pool of fixed number of blocks kept in a memory mapped file. The
+// IndexedMemoryPool state is stored in the file header, so reopening the file
+// restores the pool without touching any block. Blocks refer to each other by
+// indices, since the file may be mapped at other address next time.
+template <class DataType>
+class PersistentMemoryPool
+{
+    static_assert(std::is_trivially_copyable<DataType>::value,
+        "Blocks are restored from file without construction");
+
+    public:
+
+        // Opens existing file, in which case numberOfBlocks is ignored, or
+        // creates new one of numberOfBlocks free blocks. The last index is
+        // reserved for INDEXED_MEMORY_POOL_NULL_INDEX, so numberOfBlocks must
+        // not exceed it.
+        PersistentMemoryPool(const char *fileName, std::size_t numberOfBlocks) :
+            fileDescriptor(-1),
+            fileSize(0),
+            header(NULL)
+        {
+            if(numberOfBlocks > INDEXED_MEMORY_POOL_NULL_INDEX)
+                throw std::length_error("Too many blocks for indexed memory pool");
+
+            fileDescriptor = ::open(fileName, O_RDWR | O_CREAT, 0644);
+            if(fileDescriptor < 0)
+                throw std::system_error(errno, std::generic_category(), fileName);
+
+            struct stat fileStatus;
+            if(::fstat(fileDescriptor, &fileStatus) != 0)
+                throwSystemError(fileName);
+
+            restored = fileStatus.st_size != 0;
+            if(restored) {
+                fileSize = static_cast<std::size_t>(fileStatus.st_size);
+            } else {
+                fileSize = getFileSize(numberOfBlocks);
+                if(::ftruncate(fileDescriptor, fileSize) != 0)
+                    throwSystemError(fileName);
+            }
+
+            void *mapping = ::mmap(NULL, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+            if(mapping == MAP_FAILED)
+                throwSystemError(fileName);
+            header = static_cast<Header *>(mapping);
+
+            if(restored) {
+                if(!isCompatible()) {
+                    close();
+                    throw std::runtime_error(std::string("Incompatible memory pool file: ") + fileName);
+                }
+            } else {
+                std::memcpy(header->signature, getSignature(), sizeof(header->signature));
+                header->version = version;
+                header->rootIndex = INDEXED_MEMORY_POOL_NULL_INDEX;
+                header->numberOfBlocks = numberOfBlocks;
+                ::inlinedInitializeIndexedMemoryPool(&header->memoryPool, getMemoryRegion(),
+                    numberOfBlocks, sizeof(DataType));
+            }
+
+            // Only the pointer is not valid after the file is mapped again
+            header->memoryPool.memoryRegion = getMemoryRegion();
+        }
+
+        ~PersistentMemoryPool()
+        {
+            close();
+        }
+
+        // Returns true when the pool has been restored from existing file
+        bool isRestored() const
+        {
+            return restored;
+        }
+
+        DataType *allocateBlock()
+        {
+            void *pointer = ::inlinedAllocateIndexedBlock(&header->memoryPool);
+            if(!pointer)
+                throw std::bad_alloc();
+
+            DataType *data = static_cast<DataType *>(pointer);
+            new (data) DataType;
+
+            return data;
+        }
+
+        void releaseBlock(DataType *pointer)
+        {
+            ::inlinedReleaseIndexedBlock(&header->memoryPool, pointer);
+        }
+
+        std::uint32_t getIndex(const DataType *pointer) const
+        {
+            return ::inlinedGetIndexOfIndexedBlock(&header->memoryPool, pointer);
+        }
+
+        DataType *getBlock(std::uint32_t index) const
+        {
+            return static_cast<DataType *>(::inlinedGetIndexedBlock(&header->memoryPool, index));
+        }
+
+        // Index of the block, from which the stored structure is reached
+        // after restore. INDEXED_MEMORY_POOL_NULL_INDEX by default.
+        std::uint32_t getRootIndex() const
+        {
+            return header->rootIndex;
+        }
+
+        void setRootIndex(std::uint32_t index)
+        {
+            header->rootIndex = index;
+        }
+
+        // Writes modified pages to the file. It is done by the system anyway,
+        // also when the process is killed, but not when the system crashes.
+        void flush()
+        {
+            if(::msync(header, fileSize, MS_SYNC) != 0)
+                throw std::system_error(errno, std::generic_category(), "msync");
+        }
+
+
+    private:
+
+        struct Header
+        {
+            char signature[8];
+            std::uint32_t version;
+            std::uint32_t rootIndex;
+            std::uint64_t numberOfBlocks;
+            IndexedMemoryPool memoryPool;
+        };
+
+        // Keeps blocks aligned to the cache line
+        static const std::size_t headerSize = (sizeof(Header) + 63) & ~static_cast<std::size_t>(63);
+        static const std::uint32_t version = 1;
+
+        int fileDescriptor;
+        std::size_t fileSize;
+        Header *header;
+        bool restored;
+
+        static const char *getSignature()
+        {
+            return "FixMemAl";
+        }
+
+        static std::size_t getBlockSize()
+        {
+            IndexedMemoryPool memoryPool;
+            ::inlinedInitializeIndexedMemoryPool(&memoryPool, NULL, 0, sizeof(DataType));
+
+            return memoryPool.blockSize;
+        }
+
+        static std::size_t getFileSize(std::size_t numberOfBlocks)
+        {
+            return headerSize + numberOfBlocks * getBlockSize();
+        }
+
+        std::uint8_t *getMemoryRegion() const
+        {
+            return reinterpret_cast<std::uint8_t *>(header) + headerSize;
+        }
+
+        // The file must be created by the same build for the same type
+        bool isCompatible() const
+        {
+            return fileSize >= headerSize &&
+                std::memcmp(header->signature, getSignature(), sizeof(header->signature)) == 0 &&
+                header->version == version &&
+                header->memoryPool.blockSize == getBlockSize() &&
+                fileSize >= getFileSize(header->numberOfBlocks);
+        }
+
+        void close()
+        {
+            if(header)
+                ::munmap(header, fileSize);
+            if(fileDescriptor >= 0)
+                ::close(fileDescriptor);
+
+            header = NULL;
+            fileDescriptor = -1;
+        }
+
+        void throwSystemError(const char *fileName)
+        {
+            int errorCode = errno;
+            close();
+            throw std::system_error(errorCode, std::generic_category(), fileName);
+        }
+
+        PersistentMemoryPool(const PersistentMemoryPool &persistentMemoryPool);
+        PersistentMemoryPool & operator =(const PersistentMemoryPool &persistentMemoryPool);
+};
+
+#endif
+
+#endif
@@ -0,0 +1,333 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef PooledObjectH
+#define PooledObjectH
+
+#include <new>
+#include <mutex>
+#include <cstdint>
+#include <cstdlib>
+#include "ConcurrentMemoryPool.h"
+#include "FixedMemoryPool.h"
+#include "GrowingMemoryPool.h"
+
+// Memory pools of PooledObject types. Objects may be deleted by other thread
+// or during static destruction, so memory pools are never destroyed and their
+// memory regions are never released.
+template <class Derived, std::size_t GrowByNumberOfBlocks>
+struct SharedObjectPool
+{
+    typedef FixedMemoryPool<sizeof(Derived), alignof(Derived)> FixedPool;
+
+    static void *allocateBlock()
+    {
+        ConcurrentMemoryPool *memoryPool = getMemoryPool();
+        void *pointer = ::inlinedAllocateBlockConcurrent(memoryPool);
+
+        while(!pointer) {
+            allocateNewMemoryRegion(memoryPool);
+            pointer = ::inlinedAllocateBlockConcurrent(memoryPool);
+        }
+
+        return pointer;
+    }
+
+    static void releaseBlock(void *pointer)
+    {
+        ::inlinedReleaseBlockConcurrent(getMemoryPool(), pointer);
+    }
+
+    static ConcurrentMemoryPool *getMemoryPool()
+    {
+        static ConcurrentMemoryPool *memoryPool = createMemoryPool();
+        return memoryPool;
+    }
+
+    static ConcurrentMemoryPool *createMemoryPool()
+    {
+        ConcurrentMemoryPool *memoryPool = new ConcurrentMemoryPool;
+        ::inlinedInitializeConcurrentMemoryPool(memoryPool, NULL, 0, FixedPool::alignedBlockSize);
+        return memoryPool;
+    }
+
+    static void allocateNewMemoryRegion(ConcurrentMemoryPool *memoryPool)
+    {
+        std::uint8_t *buffer = static_cast<std::uint8_t *>(
+            malloc(FixedPool::getMemoryRegionSize(GrowByNumberOfBlocks)));
+        if(!buffer)
+            throw std::bad_alloc();
+
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(buffer);
+        address = (address + alignof(Derived) - 1) & ~(std::uintptr_t(alignof(Derived)) - 1);
+
+        // Other thread could have extended the pool in the meantime
+        if(!::inlinedExtendConcurrentMemoryPool(memoryPool,
+            reinterpret_cast<void *>(address), GrowByNumberOfBlocks))
+            free(buffer);
+    }
+};
+
+// Blocks released by other thread than the allocating one are taken over by
+// memory pool of the releasing thread. Memory pool of exited thread is handed
+// over to the next new thread, so number of memory pools does not exceed the
+// number of threads running at the same time.
+template <class Derived, std::size_t GrowByNumberOfBlocks>
+struct ThreadLocalObjectPool
+{
+    struct alignas(Derived) Block
+    {
+        std::uint8_t data[sizeof(Derived)];
+    };
+
+    typedef GrowingMemoryPool<Block, alignof(Derived)> BlockPool;
+
+    struct ThreadMemoryPool
+    {
+        BlockPool memoryPool;
+        ThreadMemoryPool *nextMemoryPool;
+
+        ThreadMemoryPool() :
+            memoryPool(GrowByNumberOfBlocks),
+            nextMemoryPool(NULL)
+        {
+        }
+    };
+
+    // Memory pools of exited threads
+    struct OrphanedMemoryPools
+    {
+        std::mutex mutex;
+        ThreadMemoryPool *firstMemoryPool;
+
+        OrphanedMemoryPools() :
+            firstMemoryPool(NULL)
+        {
+        }
+    };
+
+    // Trivially destructible, so it is valid until the thread ends, also in
+    // destructors of other thread_local objects
+    struct ThreadState
+    {
+        ThreadMemoryPool *memoryPool;
+        bool isExited;
+    };
+
+    // Hands the memory pool over when the thread exits
+    struct ThreadExit
+    {
+        ~ThreadExit()
+        {
+            ThreadState &threadState = getThreadState();
+
+            releaseMemoryPool(threadState.memoryPool);
+            threadState.memoryPool = NULL;
+            threadState.isExited = true;
+        }
+    };
+
+    static void *allocateBlock()
+    {
+        if(ThreadMemoryPool *threadMemoryPool = getMemoryPool())
+            return threadMemoryPool->memoryPool.allocateBlock();
+
+        OrphanedMemoryPools &orphanedMemoryPools = getOrphanedMemoryPools();
+        std::lock_guard<std::mutex> lock(orphanedMemoryPools.mutex);
+
+        return getOrphanedMemoryPool(orphanedMemoryPools)->memoryPool.allocateBlock();
+    }
+
+    static void releaseBlock(void *pointer)
+    {
+        if(ThreadMemoryPool *threadMemoryPool = getMemoryPool()) {
+            threadMemoryPool->memoryPool.releaseBlock(static_cast<Block *>(pointer));
+            return;
+        }
+
+        OrphanedMemoryPools &orphanedMemoryPools = getOrphanedMemoryPools();
+        std::lock_guard<std::mutex> lock(orphanedMemoryPools.mutex);
+
+        getOrphanedMemoryPool(orphanedMemoryPools)->memoryPool.releaseBlock(static_cast<Block *>(pointer));
+    }
+
+    // Returns NULL once the thread has exited, in which case objects deleted
+    // by destructors of other thread_local objects go to an orphaned memory
+    // pool under the lock
+    static ThreadMemoryPool *getMemoryPool()
+    {
+        ThreadState &threadState = getThreadState();
+
+        if(!threadState.memoryPool && !threadState.isExited) {
+            thread_local ThreadExit threadExit;
+            (void) threadExit;
+
+            threadState.memoryPool = acquireMemoryPool();
+        }
+
+        return threadState.memoryPool;
+    }
+
+    static ThreadState &getThreadState()
+    {
+        thread_local ThreadState threadState = { NULL, false };
+        return threadState;
+    }
+
+    // Never destroyed, as threads may exit during static destruction
+    static OrphanedMemoryPools &getOrphanedMemoryPools()
+    {
+        static OrphanedMemoryPools *orphanedMemoryPools = new OrphanedMemoryPools;
+        return *orphanedMemoryPools;
+    }
+
+    static ThreadMemoryPool *acquireMemoryPool()
+    {
+        OrphanedMemoryPools &orphanedMemoryPools = getOrphanedMemoryPools();
+
+        {
+            std::lock_guard<std::mutex> lock(orphanedMemoryPools.mutex);
+
+            ThreadMemoryPool *threadMemoryPool = orphanedMemoryPools.firstMemoryPool;
+            if(threadMemoryPool) {
+                orphanedMemoryPools.firstMemoryPool = threadMemoryPool->nextMemoryPool;
+                return threadMemoryPool;
+            }
+        }
+
+        return new ThreadMemoryPool;
+    }
+
+    static void releaseMemoryPool(ThreadMemoryPool *threadMemoryPool)
+    {
+        if(!threadMemoryPool)
+            return;
+
+        OrphanedMemoryPools &orphanedMemoryPools = getOrphanedMemoryPools();
+        std::lock_guard<std::mutex> lock(orphanedMemoryPools.mutex);
+
+        threadMemoryPool->nextMemoryPool = orphanedMemoryPools.firstMemoryPool;
+        orphanedMemoryPools.firstMemoryPool = threadMemoryPool;
+    }
+
+    // Lock must be held, the memory pool stays on the list
+    static ThreadMemoryPool *getOrphanedMemoryPool(OrphanedMemoryPools &orphanedMemoryPools)
+    {
+        if(!orphanedMemoryPools.firstMemoryPool)
+            orphanedMemoryPools.firstMemoryPool = new ThreadMemoryPool;
+
+        return orphanedMemoryPools.firstMemoryPool;
+    }
+};
+
+// Base class, which makes plain new and delete expressions of Derived class
+// allocate from ObjectPool. Objects of classes derived further, which differ
+// in size, are passed to the global operators. Since the size of deleted object
+// is needed, only sized operator delete is provided and nothrow forms of
+// operator new are hidden.
+template <class Derived, class ObjectPool>
+class BasicPooledObject
+{
+    public:
+
+        static void *operator new(std::size_t size)
+        {
+            if(size != sizeof(Derived))
+                return ::operator new(size);
+
+            return ObjectPool::allocateBlock();
+        }
+
+        static void *operator new(std::size_t, void *place) noexcept
+        {
+            return place;
+        }
+
+        static void operator delete(void *pointer, std::size_t size)
+        {
+            if(!pointer)
+                return;
+
+            if(size != sizeof(Derived))
+                ::operator delete(pointer);
+            else
+                ObjectPool::releaseBlock(pointer);
+        }
+
+        static void operator delete(void *, void *) noexcept
+        {
+        }
+
+#if defined(__cpp_aligned_new)
+        // Used instead of above ones for classes aligned more than
+        // __STDCPP_DEFAULT_NEW_ALIGNMENT__, memory pool keeps their alignment
+        static void *operator new(std::size_t size, std::align_val_t alignment)
+        {
+            if(size != sizeof(Derived) || std::size_t(alignment) > alignof(Derived))
+                return ::operator new(size, alignment);
+
+            return ObjectPool::allocateBlock();
+        }
+
+        static void operator delete(void *pointer, std::size_t size, std::align_val_t alignment)
+        {
+            if(!pointer)
+                return;
+
+            if(size != sizeof(Derived) || std::size_t(alignment) > alignof(Derived))
+                ::operator delete(pointer, alignment);
+            else
+                ObjectPool::releaseBlock(pointer);
+        }
+#endif
+
+
+    protected:
+
+        BasicPooledObject()
+        {
+        }
+
+        ~BasicPooledObject()
+        {
+        }
+};
+
+// Objects are allocated from single lock-free memory pool per type
+template <class Derived, std::size_t GrowByNumberOfBlocks = 1024>
+using PooledObject = BasicPooledObject<Derived, SharedObjectPool<Derived, GrowByNumberOfBlocks> >;
+
+// Objects are allocated from memory pool of the calling thread without locking
+template <class Derived, std::size_t GrowByNumberOfBlocks = 1024>
+using ThreadLocalPooledObject =
+    BasicPooledObject<Derived, ThreadLocalObjectPool<Derived, GrowByNumberOfBlocks> >;
+
+#endif
@@ -0,0 +1,287 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef SharedMemoryPoolH
+#define SharedMemoryPoolH
+
+#include <new>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include "ConcurrentIndexedMemoryPool.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Memory pool of fixed number of blocks placed in POSIX shared memory object,
+// which is used by multiple processes at the same time. Each process maps it
+// at its own address, so processes exchange indices of blocks instead of
+// pointers, while the payload is not copied.
+template <class DataType>
+class SharedMemoryPool
+{
+    static_assert(std::is_trivially_copyable<DataType>::value,
+        "Blocks are accessed by processes, which have not constructed them");
+
+    public:
+
+        // The first process creates the shared memory object of numberOfBlocks
+        // blocks, while other processes open it and wait until it is ready.
+        // Waiting longer than timeout, as when the creating process has died,
+        // throws std::system_error with ETIMEDOUT. When creation fails, the
+        // shared memory object is removed again. The last index is reserved
+        // for INDEXED_MEMORY_POOL_NULL_INDEX, so numberOfBlocks must not
+        // exceed it.
+        SharedMemoryPool(const char *name, std::size_t numberOfBlocks,
+            std::chrono::milliseconds timeout = std::chrono::seconds(5)) :
+            fileDescriptor(-1),
+            size(0),
+            header(NULL),
+            created(false)
+        {
+            if(numberOfBlocks > INDEXED_MEMORY_POOL_NULL_INDEX)
+                throw std::length_error("Too many blocks for indexed memory pool");
+
+            const std::chrono::steady_clock::time_point deadline =
+                std::chrono::steady_clock::now() + timeout;
+
+            fileDescriptor = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+            if(fileDescriptor >= 0) {
+                created = true;
+                size = getSize(numberOfBlocks);
+                if(::ftruncate(fileDescriptor, size) != 0)
+                    throwSystemError(name);
+            } else {
+                if(errno != EEXIST)
+                    throw std::system_error(errno, std::generic_category(), name);
+
+                fileDescriptor = ::shm_open(name, O_RDWR, 0600);
+                if(fileDescriptor < 0)
+                    throw std::system_error(errno, std::generic_category(), name);
+
+                size = waitForSize(name, deadline);
+            }
+
+            void *mapping = ::mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+            if(mapping == MAP_FAILED)
+                throwSystemError(name);
+            header = static_cast<Header *>(mapping);
+
+            if(created) {
+                std::memcpy(header->signature, getSignature(), sizeof(header->signature));
+                header->version = version;
+                ::inlinedInitializeConcurrentIndexedMemoryPool(&header->memoryPool,
+                    getMemoryRegion(), numberOfBlocks, sizeof(DataType));
+
+                ::atomicFullBarrier();
+                header->isInitialized = 1;
+            } else {
+                if(size < headerSize) {
+                    close();
+                    throw std::runtime_error(std::string("Incompatible shared memory pool: ") + name);
+                }
+
+                while(!header->isInitialized)
+                    waitUntil(name, deadline);
+                ::atomicFullBarrier();
+
+                if(!isCompatible()) {
+                    close();
+                    throw std::runtime_error(std::string("Incompatible shared memory pool: ") + name);
+                }
+            }
+        }
+
+        // The shared memory object remains until it is removed
+        ~SharedMemoryPool()
+        {
+            close();
+        }
+
+        // Removes name of the shared memory object, which is destroyed once
+        // all processes unmap it
+        static bool remove(const char *name)
+        {
+            return ::shm_unlink(name) == 0;
+        }
+
+        // Returns true when this process has created the shared memory object
+        bool isCreated() const
+        {
+            return created;
+        }
+
+        // Returns NULL when all blocks are in use
+        DataType *allocateBlock()
+        {
+            void *pointer = ::inlinedAllocateIndexedBlockConcurrent(&header->memoryPool);
+            if(!pointer)
+                return NULL;
+
+            DataType *data = static_cast<DataType *>(pointer);
+            new (data) DataType;
+
+            return data;
+        }
+
+        // Block may be released by other process than the one, which has
+        // allocated it
+        void releaseBlock(DataType *pointer)
+        {
+            ::inlinedReleaseIndexedBlockConcurrent(&header->memoryPool, pointer);
+        }
+
+        std::uint32_t getIndex(const DataType *pointer) const
+        {
+            return ::inlinedGetIndexOfConcurrentIndexedBlock(&header->memoryPool, pointer);
+        }
+
+        DataType *getBlock(std::uint32_t index) const
+        {
+            return static_cast<DataType *>(::inlinedGetConcurrentIndexedBlock(&header->memoryPool, index));
+        }
+
+
+    private:
+
+        struct Header
+        {
+            char signature[8];
+            std::uint32_t version;
+            volatile std::uint32_t isInitialized;
+            ConcurrentIndexedMemoryPool memoryPool;
+        };
+
+        // Keeps blocks aligned to the cache line
+        static const std::size_t headerSize = (sizeof(Header) + 63) & ~static_cast<std::size_t>(63);
+        static const std::uint32_t version = 1;
+
+        int fileDescriptor;
+        std::size_t size;
+        Header *header;
+        bool created;
+
+        static const char *getSignature()
+        {
+            return "FixMemSh";
+        }
+
+        static std::size_t getBlockSize()
+        {
+            ConcurrentIndexedMemoryPool memoryPool;
+            ::inlinedInitializeConcurrentIndexedMemoryPool(&memoryPool, NULL, 0, sizeof(DataType));
+
+            return memoryPool.blockSize;
+        }
+
+        static std::size_t getSize(std::size_t numberOfBlocks)
+        {
+            return headerSize + numberOfBlocks * getBlockSize();
+        }
+
+        std::uint8_t *getMemoryRegion() const
+        {
+            return reinterpret_cast<std::uint8_t *>(header) + headerSize;
+        }
+
+        // Size is set by the creating process just after the object is created
+        std::size_t waitForSize(const char *name, std::chrono::steady_clock::time_point deadline)
+        {
+            for(;;) {
+                struct stat status;
+                if(::fstat(fileDescriptor, &status) != 0)
+                    throwSystemError(name);
+
+                if(status.st_size)
+                    return static_cast<std::size_t>(status.st_size);
+
+                waitUntil(name, deadline);
+            }
+        }
+
+        // Yields to the creating process, or throws once the deadline passes
+        void waitUntil(const char *name, std::chrono::steady_clock::time_point deadline)
+        {
+            if(std::chrono::steady_clock::now() > deadline) {
+                close();
+                throw std::system_error(ETIMEDOUT, std::generic_category(), name);
+            }
+
+            std::this_thread::yield();
+        }
+
+        bool isCompatible() const
+        {
+            return std::memcmp(header->signature, getSignature(), sizeof(header->signature)) == 0 &&
+                header->version == version &&
+                header->memoryPool.blockSize == getBlockSize() &&
+                size >= getSize(header->memoryPool.numberOfBlocks);
+        }
+
+        void close()
+        {
+            if(header)
+                ::munmap(header, size);
+            if(fileDescriptor >= 0)
+                ::close(fileDescriptor);
+
+            header = NULL;
+            fileDescriptor = -1;
+        }
+
+        // Object created by this process is removed, so other processes do not
+        // wait for it
+        void throwSystemError(const char *name)
+        {
+            int errorCode = errno;
+            close();
+            if(created)
+                ::shm_unlink(name);
+            throw std::system_error(errorCode, std::generic_category(), name);
+        }
+
+        SharedMemoryPool(const SharedMemoryPool &sharedMemoryPool);
+        SharedMemoryPool & operator =(const SharedMemoryPool &sharedMemoryPool);
+};
+
+#endif
+
+#endif
@@ -32,37 +32,101 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #ifndef StaticMemoryPoolH
 #define StaticMemoryPoolH
 
-#include "MemoryPool.h"
-
-template <class DataType>
-class StaticMemoryPool : protected MemoryPool
+#include <new>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include "FixedMemoryPool.h"
+
+template <class DataType, std::size_t Alignment = alignof(DataType)>
+class StaticMemoryPool : protected FixedMemoryPool<sizeof(DataType), Alignment>
 {
     public:
 
-        StaticMemoryPool(DataType *memoryRegion, std::size_t numberOfBlocks)
+        typedef FixedMemoryPool<sizeof(DataType), Alignment> FixedPool;
+
+        // Blocks may be padded or realigned, in which case less than
+        // numberOfBlocks of them fit into the memory region
+        StaticMemoryPool(DataType *memoryRegion, std::size_t numberOfBlocks) :
+            FixedPool(memoryRegion, getNumberOfBlocks(memoryRegion, numberOfBlocks))
         {
-            ::inlinedInitializeMemoryPool(this, memoryRegion, numberOfBlocks, sizeof(DataType));
         }
 
+        StaticMemoryPool(StaticMemoryPool &&staticMemoryPool) :
+            FixedPool(std::move(staticMemoryPool))
+        {
+        }
+
+        StaticMemoryPool & operator =(StaticMemoryPool &&staticMemoryPool)
+        {
+            FixedPool::operator =(std::move(staticMemoryPool));
+            return *this;
+        }
+
+        // Returns NULL when all blocks are in use
         DataType *allocateBlock()
         {
-            void *pointer = ::inlinedAllocateBlock(this);
+            DataType *data = allocateUninitialized();
+            if(data)
+                new (data) DataType;
+
+            return data;
+        }
+
+        // Constructs the block from given arguments, instead of default
+        // construction followed by assignment
+        template <class... Args>
+        DataType *construct(Args &&... args)
+        {
+            DataType *data = allocateUninitialized();
+            if(!data)
+                return NULL;
 
-            DataType *data = static_cast<DataType *>(pointer);
-            new (data) DataType;
+            try {
+                new (data) DataType(std::forward<Args>(args)...);
+            } catch(...) {
+                FixedPool::releaseBlock(data);
+                throw;
+            }
 
             return data;
         }
 
+        // Block is not constructed, it must be released by releaseUninitialized
+        DataType *allocateUninitialized()
+        {
+            return static_cast<DataType *>(FixedPool::allocateBlock());
+        }
+
         void releaseBlock(DataType *pointer)
         {
             pointer->~DataType();
-            ::inlinedReleaseBlock(this, pointer);
+            FixedPool::releaseBlock(pointer);
         }
 
+        void releaseUninitialized(DataType *pointer)
+        {
+            FixedPool::releaseBlock(pointer);
+        }
+
+#ifdef MEMORY_POOL_STATISTICS
+        using FixedPool::getStatistics;
+#endif
+
 
     private:
 
+        static std::size_t getNumberOfBlocks(DataType *memoryRegion, std::size_t numberOfBlocks)
+        {
+            std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(memoryRegion);
+            std::uintptr_t end = begin + numberOfBlocks * sizeof(DataType);
+
+            if(Alignment > 1)
+                begin = (begin + Alignment - 1) & ~(static_cast<std::uintptr_t>(Alignment) - 1);
+
+            return begin < end ? (end - begin) / FixedPool::alignedBlockSize : 0;
+        }
+
         StaticMemoryPool(const StaticMemoryPool &staticMemoryPool);
         StaticMemoryPool & operator =(const StaticMemoryPool &staticMemoryPool);
 };
@@ -0,0 +1,344 @@
+/*
+FixMemAlloc - Fixed-size blocks allocation for C and C++
+
+Copyright (c) 2016, Mariusz Moczala
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of FixMemAlloc nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#ifndef ThreadCachingMemoryPoolH
+#define ThreadCachingMemoryPoolH
+
+#include <new>
+#include <mutex>
+#include <vector>
+#include "FixedMemoryPool.h"
+#include "MemoryRegion.h"
+#include "MemoryPoolStatistics.h"
+
+template <class DataType, std::size_t Alignment = alignof(DataType)>
+class ThreadCachingMemoryPool : protected FixedMemoryPool<sizeof(DataType), Alignment>
+{
+    public:
+
+        typedef FixedMemoryPool<sizeof(DataType), Alignment> FixedPool;
+
+        ThreadCachingMemoryPool(std::size_t growByNumberOfBlocks,
+            std::size_t maxNumberOfCachedBlocks = 256,
+            MemoryRegionType memoryRegionType = DefaultMemoryRegion) :
+            growByNumberOfBlocks(growByNumberOfBlocks),
+            maxNumberOfCachedBlocks(maxNumberOfCachedBlocks ? maxNumberOfCachedBlocks : 1),
+            memoryRegionType(memoryRegionType),
+            firstMemoryRegion(NULL),
+            firstThreadCache(NULL)
+        {
+            std::lock_guard<std::mutex> lock(getRegistryMutex());
+            identifier = acquireIdentifier();
+        }
+
+        // Threads may still hold caches of the memory pool. Those are only
+        // detached here and deleted by their threads later.
+        ~ThreadCachingMemoryPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(getRegistryMutex());
+
+                for(ThreadCache *threadCache = firstThreadCache; threadCache;
+                    threadCache = threadCache->nextThreadCache)
+                    threadCache->owner = NULL;
+
+                getFreeIdentifiers().push_back(identifier);
+            }
+
+            while(firstMemoryRegion) {
+                MemoryRegion *memoryRegion = firstMemoryRegion;
+                firstMemoryRegion = memoryRegion->nextMemoryRegion;
+
+                ::releaseMemoryRegion(memoryRegion->buffer, memoryRegion->size, memoryRegionType);
+                delete memoryRegion;
+            }
+        }
+
+        DataType *allocateBlock()
+        {
+            ThreadCache *threadCache = getThreadCache();
+            void *pointer = ::inlinedAllocateBlock(threadCache);
+
+            if(!pointer) {
+                refillThreadCache(threadCache);
+                pointer = ::inlinedAllocateBlock(threadCache);
+            }
+
+            threadCache->numberOfCachedBlocks--;
+
+            DataType *data = static_cast<DataType *>(pointer);
+            new (data) DataType;
+
+            return data;
+        }
+
+        // Block may be released by other thread than the allocating one, it is
+        // cached by the releasing thread then
+        void releaseBlock(DataType *pointer)
+        {
+            pointer->~DataType();
+
+            ThreadCache *threadCache = getThreadCache();
+            ::inlinedReleaseBlock(threadCache, pointer);
+
+            if(++threadCache->numberOfCachedBlocks > maxNumberOfCachedBlocks)
+                flushThreadCache(threadCache, (threadCache->numberOfCachedBlocks + 1) / 2);
+        }
+
+#ifdef MEMORY_POOL_STATISTICS
+        // Statistics of the shared memory pool, which counts blocks moved to
+        // and from thread caches
+        MemoryPoolSnapshot getStatistics() const
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return FixedPool::getStatistics();
+        }
+#endif
+
+
+    private:
+
+        struct MemoryRegion
+        {
+            MemoryRegion *nextMemoryRegion;
+            void *buffer;
+            std::size_t size;
+            std::size_t numberOfBlocks;
+        };
+
+        struct ThreadCache : public MemoryPool
+        {
+            std::size_t numberOfCachedBlocks;
+            ThreadCachingMemoryPool *owner;
+            ThreadCache *previousThreadCache;
+            ThreadCache *nextThreadCache;
+            std::vector<void *> refillBuffer;
+        };
+
+        // Caches of the calling thread indexed by identifiers of memory pools
+        class ThreadCacheDirectory
+        {
+            public:
+
+                std::vector<ThreadCache *> threadCaches;
+
+                ~ThreadCacheDirectory()
+                {
+                    std::lock_guard<std::mutex> lock(getRegistryMutex());
+
+                    for(std::size_t i = 0; i < threadCaches.size(); i++) {
+                        ThreadCache *threadCache = threadCaches[i];
+                        if(!threadCache)
+                            continue;
+
+                        if(threadCache->owner) {
+                            threadCache->owner->flushThreadCache(threadCache,
+                                threadCache->numberOfCachedBlocks);
+                            threadCache->owner->unregisterThreadCache(threadCache);
+                        }
+
+                        delete threadCache;
+                    }
+                }
+        };
+
+        std::size_t growByNumberOfBlocks;
+        std::size_t maxNumberOfCachedBlocks;
+        MemoryRegionType memoryRegionType;
+        std::size_t identifier;
+        MemoryRegion *firstMemoryRegion;
+        ThreadCache *firstThreadCache;
+        mutable std::mutex mutex;
+
+        static std::mutex &getRegistryMutex()
+        {
+            static std::mutex registryMutex;
+            return registryMutex;
+        }
+
+        // Identifiers of destroyed memory pools are reused, so the directories
+        // do not grow with each memory pool ever created
+        static std::vector<std::size_t> &getFreeIdentifiers()
+        {
+            static std::vector<std::size_t> freeIdentifiers;
+            return freeIdentifiers;
+        }
+
+        static std::size_t acquireIdentifier()
+        {
+            static std::size_t nextIdentifier = 0;
+            std::vector<std::size_t> &freeIdentifiers = getFreeIdentifiers();
+
+            if(freeIdentifiers.empty())
+                return nextIdentifier++;
+
+            std::size_t freeIdentifier = freeIdentifiers.back();
+            freeIdentifiers.pop_back();
+
+            return freeIdentifier;
+        }
+
+        static ThreadCacheDirectory &getThreadCacheDirectory()
+        {
+            static thread_local ThreadCacheDirectory threadCacheDirectory;
+            return threadCacheDirectory;
+        }
+
+        // Cache left by destroyed memory pool of the same identifier is not
+        // owned by this one
+        ThreadCache *getThreadCache()
+        {
+            std::vector<ThreadCache *> &threadCaches = getThreadCacheDirectory().threadCaches;
+
+            if(identifier < threadCaches.size() && threadCaches[identifier] &&
+                threadCaches[identifier]->owner == this)
+                return threadCaches[identifier];
+
+            return createThreadCache(threadCaches);
+        }
+
+        ThreadCache *createThreadCache(std::vector<ThreadCache *> &threadCaches)
+        {
+            std::lock_guard<std::mutex> lock(getRegistryMutex());
+
+            // Caches of already destroyed pools are no longer needed
+            for(std::size_t i = 0; i < threadCaches.size(); i++) {
+                if(threadCaches[i] && !threadCaches[i]->owner) {
+                    delete threadCaches[i];
+                    threadCaches[i] = NULL;
+                }
+            }
+
+            if(identifier >= threadCaches.size())
+                threadCaches.resize(identifier + 1, NULL);
+
+            ThreadCache *threadCache = new ThreadCache;
+            ::inlinedInitializeMemoryPool(threadCache, NULL, 0, FixedPool::alignedBlockSize);
+            threadCache->numberOfCachedBlocks = 0;
+            threadCache->refillBuffer.resize((maxNumberOfCachedBlocks + 1) / 2);
+            threadCache->owner = this;
+            threadCache->previousThreadCache = NULL;
+            threadCache->nextThreadCache = firstThreadCache;
+
+            if(firstThreadCache)
+                firstThreadCache->previousThreadCache = threadCache;
+            firstThreadCache = threadCache;
+
+            threadCaches[identifier] = threadCache;
+            return threadCache;
+        }
+
+        void unregisterThreadCache(ThreadCache *threadCache)
+        {
+            if(threadCache->previousThreadCache)
+                threadCache->previousThreadCache->nextThreadCache = threadCache->nextThreadCache;
+            else
+                firstThreadCache = threadCache->nextThreadCache;
+
+            if(threadCache->nextThreadCache)
+                threadCache->nextThreadCache->previousThreadCache = threadCache->previousThreadCache;
+
+            threadCache->owner = NULL;
+        }
+
+        void refillThreadCache(ThreadCache *threadCache)
+        {
+            std::size_t numberOfBlocks = threadCache->refillBuffer.size();
+            void **pointers = &threadCache->refillBuffer[0];
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+
+#ifdef MEMORY_POOL_STATISTICS
+                // Blocks missing until the next memory region are not failed
+                std::size_t numberOfFailedAllocations = this->statistics.numberOfFailedAllocations;
+#endif
+
+                std::size_t numberOfAllocatedBlocks = ::inlinedAllocateBlocks(this, pointers, numberOfBlocks);
+                while(numberOfAllocatedBlocks < numberOfBlocks) {
+                    allocateNewMemoryRegion();
+                    numberOfAllocatedBlocks += ::inlinedAllocateBlocks(this,
+                        pointers + numberOfAllocatedBlocks, numberOfBlocks - numberOfAllocatedBlocks);
+                }
+
+#ifdef MEMORY_POOL_STATISTICS
+                this->statistics.numberOfFailedAllocations = numberOfFailedAllocations;
+#endif
+            }
+
+            ::inlinedReleaseBlocks(threadCache, pointers, numberOfBlocks);
+            threadCache->numberOfCachedBlocks += numberOfBlocks;
+        }
+
+        void flushThreadCache(ThreadCache *threadCache, std::size_t numberOfBlocks)
+        {
+            if(!numberOfBlocks)
+                return;
+
+            void *firstBlock = threadCache->firstFreeBlock;
+            void *lastBlock = firstBlock;
+
+            for(std::size_t i = 1; i < numberOfBlocks; i++)
+                lastBlock = *static_cast<void **>(lastBlock);
+
+            threadCache->firstFreeBlock = *static_cast<void **>(lastBlock);
+            threadCache->numberOfCachedBlocks -= numberOfBlocks;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            ::inlinedReleaseBlockChain(this, firstBlock, lastBlock, numberOfBlocks);
+        }
+
+        void allocateNewMemoryRegion()
+        {
+            MemoryRegion *memoryRegion = new MemoryRegion;
+            std::size_t size = FixedPool::getMemoryRegionSize(growByNumberOfBlocks);
+            void *buffer = ::allocateMemoryRegion(size, memoryRegionType);
+
+            if(!buffer) {
+                delete memoryRegion;
+                throw std::bad_alloc();
+            }
+
+            memoryRegion->nextMemoryRegion = firstMemoryRegion;
+            memoryRegion->buffer = buffer;
+            memoryRegion->size = size;
+            // Rounded up memory region may hold more blocks than requested
+            memoryRegion->numberOfBlocks = FixedPool::getNumberOfBlocks(size);
+            firstMemoryRegion = memoryRegion;
+
+            FixedPool::extend(buffer, memoryRegion->numberOfBlocks);
+        }
+
+        ThreadCachingMemoryPool(const ThreadCachingMemoryPool &threadCachingMemoryPool);
+        ThreadCachingMemoryPool & operator =(const ThreadCachingMemoryPool &threadCachingMemoryPool);
+};
+
+#endif